@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <string.h>
+#include "app.h"
+#include "button.h"
+#include "frame.h"
+#include "hal.h"
+#include "log.h"
+#include "rx_transform.h"
+#include "stats.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+
+const uint32_t BTN_PIN = 22; // button GP22
+
+#ifndef TX_PERIOD_MS
+#define TX_PERIOD_MS 1000 // transmit cadence
+#endif
+#ifndef BTN_DEBOUNCE_US
+#define BTN_DEBOUNCE_US 20000
+#endif
+
+// Bytes taken from the RX ring per transform call
+#define RX_CHUNK 64
+
+// Console command that prints the counters and histograms
+#define STATS_COMMAND "stats"
+// Console command that switches a port's link at runtime
+#define LINK_COMMAND "link"
+#define LINK_USAGE "link <port> legacy|framed <baud> <frame_payload>"
+
+static char alphabet = 'A'; // Start at 'A'
+static volatile bool tx_tick;
+static bool app_drain_rx;
+static bool got_data;
+static app_rx_tap_t rx_tap;
+static char cmd_buf[48];
+static size_t cmd_len;
+static bool cmd_overlong; // ignore the line, it didn't fit
+
+static frame_encoder_t tx_frame[UART_PORTS]; // events waiting for the next flush
+static frame_decoder_t rx_frame[UART_PORTS];
+
+// Queue the port's pending frame for transmit. Call with IRQs masked.
+static void app_flush_frame(uint32_t port) {
+    static uint8_t wire[FRAME_MAX_ENCODED]; // off the IRQ stack, only used masked
+    size_t n = frame_encoder_flush(&tx_frame[port], wire);
+    if (n) {
+        uart_tx_write(port, wire, n);
+    }
+}
+
+// Add one event to the port's current batch, flushing first if it is full
+static void app_send_event(uint32_t port, uint8_t c) {
+    uint32_t save = hal_irq_save();
+    if (!frame_encoder_add(&tx_frame[port], &c, 1)) {
+        app_flush_frame(port);
+        frame_encoder_add(&tx_frame[port], &c, 1);
+    }
+    hal_irq_restore(save);
+}
+
+// Runs in IRQ context (button press or TX timer)
+static void send_next(void) {
+    char c;
+    if (!button_is_pressed()) {
+        // Button is not pressed, send '1'
+        c = '1';
+    } else {
+        // Button is pressed, send alphabet letters
+        c = alphabet;
+        alphabet++;  // Move to the next letter
+
+        if (alphabet > 'Z') {
+            alphabet = 'A';  // Loop back to 'A' after 'Z'
+        }
+    }
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        uart_port_mode_t mode = uart_ports[port].mode;
+        if (mode == UART_PORT_OFF) {
+            continue;
+        }
+        if (mode == UART_PORT_FRAMED) {
+            app_send_event(port, c);
+        } else {
+            uart_tx_putc(port, c); // queued, never blocks
+        }
+        log_event(LOG_EVT_SENT, port, c);
+    }
+}
+
+// GPIO IRQ: a debounced press sends right away
+static void app_on_press(void) {
+    send_next();
+    stats_record(STATS_BTN_TO_TX, (uint32_t)(hal_time_us() - button_edge_us()));
+}
+
+static int64_t tx_timer_callback(int32_t id, void *user_data) {
+    send_next();
+    tx_tick = true;
+    return -(int64_t)TX_PERIOD_MS * 1000;
+}
+
+static void app_rx_frame(uint8_t seq, const uint8_t *payload, size_t len, void *ctx) {
+    uint32_t port = (uint32_t)(uintptr_t)ctx;
+    uint8_t out[FRAME_MAX_PAYLOAD];
+    size_t n = rx_transform(payload, out, len);
+    for (size_t i = 0; i < n; i++) {
+        log_event(LOG_EVT_RECEIVED, port, out[i]);
+    }
+}
+
+// Process one chunk of raw bytes received on port, in place in its RX ring
+static void app_rx_chunk(uint32_t port, uint8_t *buf, size_t n) {
+    if (rx_tap) {
+        rx_tap(port, buf, n);
+    }
+    if (uart_ports[port].mode == UART_PORT_FRAMED) {
+        frame_decoder_push(&rx_frame[port], buf, n);
+        return;
+    }
+    n = rx_transform(buf, buf, n);
+    for (size_t i = 0; i < n; i++) {
+        log_event(LOG_EVT_RECEIVED, port, buf[i]);
+    }
+}
+
+// "link <port> legacy|framed <baud> <frame_payload>"
+static void app_link_command(const char *args) {
+    unsigned long port, baud, payload;
+    char mode[8];
+    char reply[80];
+    int n;
+    if (sscanf(args, "%lu %7s %lu %lu", &port, mode, &baud, &payload) != 4 || port >= UART_PORTS ||
+        baud == 0 || (strcmp(mode, "legacy") != 0 && strcmp(mode, "framed") != 0)) {
+        n = snprintf(reply, sizeof(reply), "usage: " LINK_USAGE "\n");
+    } else {
+        uart_port_mode_t m = mode[0] == 'f' ? UART_PORT_FRAMED : UART_PORT_LEGACY;
+        uint32_t actual = app_set_link(port, m, baud, payload);
+        if (actual) {
+            n = snprintf(reply, sizeof(reply), "link uart%lu %s %lu %lu\n", port, mode,
+                         (unsigned long)actual, (unsigned long)tx_frame[port].max_payload);
+        } else {
+            n = snprintf(reply, sizeof(reply), "link uart%lu is off\n", port);
+        }
+    }
+    hal_log_write(reply, n);
+}
+
+// Answer console commands, one per line
+static void app_poll_console(void) {
+    int c;
+    while ((c = hal_log_getc()) >= 0) {
+        if (c != '\r' && c != '\n') {
+            if (cmd_len < sizeof(cmd_buf) - 1) {
+                cmd_buf[cmd_len++] = (char)c;
+            } else {
+                cmd_overlong = true;
+            }
+            continue;
+        }
+        cmd_buf[cmd_len] = '\0';
+        if (cmd_overlong) {
+            // drop it rather than act on a truncated command
+        } else if (strcmp(cmd_buf, STATS_COMMAND) == 0) {
+            static char report[1024];
+            hal_log_write(report, stats_format(report, sizeof(report)));
+        } else if (strncmp(cmd_buf, LINK_COMMAND " ", sizeof(LINK_COMMAND)) == 0) {
+            app_link_command(cmd_buf + sizeof(LINK_COMMAND));
+        }
+        cmd_len = 0;
+        cmd_overlong = false;
+    }
+}
+
+void app_init(bool drain_rx) {
+    stats_init();
+    log_init(); // Logging is queued and written out by the main loop
+
+    app_drain_rx = drain_rx;
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        frame_encoder_init(&tx_frame[port], FRAME_MAX_PAYLOAD);
+        frame_decoder_init(&rx_frame[port], app_rx_frame, (void *)(uintptr_t)port);
+        if (drain_rx && uart_ports[port].mode != UART_PORT_OFF) {
+            uart_rx_init(port); // Received bytes are buffered by the UART IRQ
+        }
+    }
+
+    //Set buttons, a press transmits straight from the GPIO IRQ
+    button_init(BTN_PIN, BTN_DEBOUNCE_US, app_on_press);
+
+    hal_alarm_in_us((uint64_t)TX_PERIOD_MS * 1000, tx_timer_callback, NULL);
+}
+
+uint32_t app_set_link(uint32_t port, uart_port_mode_t mode, uint32_t baud, uint32_t frame_payload) {
+    uart_port_t *p = &uart_ports[port];
+    if (p->mode == UART_PORT_OFF || mode == UART_PORT_OFF) {
+        return 0;
+    }
+
+    uint32_t save = hal_irq_save();
+    app_flush_frame(port); // don't strand events batched under the old settings
+    frame_encoder_set_max(&tx_frame[port], frame_payload);
+    p->mode = mode;
+    hal_irq_restore(save);
+
+    frame_decoder_init(&rx_frame[port], app_rx_frame, (void *)(uintptr_t)port);
+    p->baud = hal_uart_set_baud(port, baud);
+    return p->baud;
+}
+
+void app_set_rx_tap(app_rx_tap_t tap) {
+    rx_tap = tap;
+}
+
+void app_rx_results(uint32_t port, const uint8_t *raw, const uint8_t *out, size_t n,
+                    uint64_t arrival_us) {
+    got_data = true;
+    if (rx_tap) {
+        rx_tap(port, raw, n);
+    }
+    if (uart_ports[port].mode == UART_PORT_FRAMED) {
+        frame_decoder_push(&rx_frame[port], raw, n);
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            if (out[i]) {
+                log_event(LOG_EVT_RECEIVED, port, out[i]);
+            }
+        }
+    }
+    stats_record(STATS_RX_TO_PROCESSED, (uint32_t)(hal_time_us() - arrival_us));
+}
+
+bool app_poll(void) {
+    if (app_drain_rx) {
+        // Drain everything the RX IRQ has buffered, a chunk per port in
+        // turn so a port at full rate can't hold off the others. Chunks are
+        // handled where they sit in the ring, the tap copies straight out.
+        uint64_t arrival_us[UART_PORTS];
+        bool drained[UART_PORTS] = {false};
+        for (uint32_t port = 0; port < UART_PORTS; port++) {
+            arrival_us[port] = uart_rx_arrival_us(port);
+        }
+        bool more;
+        do {
+            more = false;
+            for (uint32_t port = 0; port < UART_PORTS; port++) {
+                if (uart_ports[port].mode == UART_PORT_OFF) {
+                    continue;
+                }
+                uint8_t *chunk;
+                size_t n = uart_rx_peek(port, &chunk, RX_CHUNK);
+                if (n > 0) {
+                    app_rx_chunk(port, chunk, n);
+                    uart_rx_consume(port, n);
+                    drained[port] = true;
+                    more = true;
+                }
+            }
+        } while (more);
+        for (uint32_t port = 0; port < UART_PORTS; port++) {
+            if (drained[port]) {
+                got_data = true;
+                stats_record(STATS_RX_TO_PROCESSED, (uint32_t)(hal_time_us() - arrival_us[port]));
+            }
+        }
+    }
+
+    if (tx_tick) {
+        tx_tick = false;
+        if (!got_data) {
+            log_event(LOG_EVT_RX_IDLE, 0, 0);
+            stats_inc(STATS_RX_IDLE);
+        }
+        got_data = false;
+    }
+
+    // Events raised since the last pass go out together in one frame per port
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        if (uart_ports[port].mode == UART_PORT_FRAMED && frame_encoder_pending(&tx_frame[port])) {
+            uint32_t save = hal_irq_save();
+            app_flush_frame(port);
+            hal_irq_restore(save);
+        }
+    }
+
+    app_poll_console();
+    return log_drain();
+}
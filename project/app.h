@@ -0,0 +1,39 @@
+#ifndef APP_H
+#define APP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "uart_port.h"
+
+// Every port that isn't UART_PORT_OFF in the port table talks to a peer
+// and is driven the same way.
+
+#define APP_UART 1 // UART1, the port bridged to UDP
+
+// Start the button, TX timer and logging. The ports must already be set up
+// with uart_ports_init(). If drain_rx is false the caller feeds received data
+// through app_rx_results() instead (e.g. from the other core).
+void app_init(bool drain_rx);
+
+// One pass of the main loop. Returns true if there is more work pending,
+// otherwise the caller may hal_wait_for_event().
+bool app_poll(void);
+
+// Report n bytes received on port that were drained and transformed elsewhere:
+// raw as received, out[i] the transform of raw[i] (0 if dropped). arrival_us
+// is when the oldest of them arrived. Handled like a chunk app_poll() drains.
+void app_rx_results(uint32_t port, const uint8_t *raw, const uint8_t *out, size_t n,
+                    uint64_t arrival_us);
+
+// Called with every chunk of raw bytes received on a port, before the
+// transform (e.g. to forward them elsewhere). NULL to remove.
+typedef void (*app_rx_tap_t)(uint32_t port, const uint8_t *data, size_t len);
+void app_set_rx_tap(app_rx_tap_t tap);
+
+// Switch a port's link at runtime. frame_payload caps the events batched per
+// frame in framed mode. Returns the baud rate actually set, 0 if the port is
+// off in the port table (mode can't turn it on).
+uint32_t app_set_link(uint32_t port, uart_port_mode_t mode, uint32_t baud, uint32_t frame_payload);
+
+#endif
@@ -0,0 +1,64 @@
+#include "button.h"
+#include "hal.h"
+
+static uint32_t btn_pin;
+static uint32_t btn_debounce_us;
+static button_press_cb_t btn_on_press;
+static volatile bool btn_pressed;
+static volatile bool btn_locked; // inside a debounce window
+static volatile uint64_t btn_edge_us;
+
+// Latch the raw level, returns true if the debounced state changed
+static bool button_sample(void) {
+    bool now = !hal_gpio_get(btn_pin); // pulled up, pressed reads low
+    if (now == btn_pressed) {
+        return false;
+    }
+    btn_pressed = now;
+    if (now && btn_on_press) {
+        btn_on_press();
+    }
+    return true;
+}
+
+static int64_t button_debounce_done(int32_t id, void *user_data) {
+    // The button may have been released (or bounced back) inside the
+    // window, so pick up any change and hold off for another window. A
+    // change seen here is acted on now, so that is its edge time.
+    btn_edge_us = hal_time_us();
+    if (button_sample()) {
+        return btn_debounce_us;
+    }
+    btn_locked = false;
+    return 0;
+}
+
+static void button_gpio_irq(uint32_t gpio) {
+    if (gpio != btn_pin || btn_locked) {
+        return;
+    }
+    btn_edge_us = hal_time_us();
+    if (button_sample()) {
+        btn_locked = true;
+        if (!hal_alarm_in_us(btn_debounce_us, button_debounce_done, NULL)) {
+            btn_locked = false; // no alarm slot free, don't get stuck locked
+        }
+    }
+}
+
+void button_init(uint32_t pin, uint32_t debounce_us, button_press_cb_t on_press) {
+    btn_pin = pin;
+    btn_debounce_us = debounce_us;
+    btn_on_press = on_press;
+
+    hal_gpio_init_button(pin, button_gpio_irq);
+    btn_pressed = !hal_gpio_get(pin);
+}
+
+uint64_t button_edge_us(void) {
+    return btn_edge_us;
+}
+
+bool button_is_pressed(void) {
+    return btn_pressed;
+}
@@ -0,0 +1,22 @@
+#ifndef BUTTON_H
+#define BUTTON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Called from the GPIO/timer IRQ as soon as a press is accepted
+typedef void (*button_press_cb_t)(void);
+
+// Watch an active-low button with a pull-up on both edges. The first edge is
+// acted on immediately; edges during the following debounce_us are ignored and
+// the level is re-checked once the window closes.
+void button_init(uint32_t pin, uint32_t debounce_us, button_press_cb_t on_press);
+
+// Debounced button state
+bool button_is_pressed(void);
+
+// Time the last accepted edge was acted on: the GPIO IRQ for a clean edge,
+// the debounce re-check for one that landed inside a window
+uint64_t button_edge_us(void);
+
+#endif
@@ -0,0 +1,164 @@
+#include "frame.h"
+
+// CRC-16/CCITT-FALSE, a nibble at a time: poly 0x1021, init 0xFFFF
+static const uint16_t crc16_nibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+uint16_t frame_crc16(uint16_t crc, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ crc16_nibble[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+static size_t cobs_encode(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t code_pos = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[code_pos] = code;
+                code_pos = o++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+// Decodes in place is fine: the output never overtakes the input
+static bool cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t *out_len) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) {
+            return false;
+        }
+        for (uint8_t k = 1; k < code; k++) {
+            out[o++] = in[i++];
+        }
+        if (code < 0xFF && i < len) {
+            out[o++] = 0;
+        }
+    }
+    *out_len = o;
+    return true;
+}
+
+void frame_encoder_init(frame_encoder_t *enc, size_t max_payload) {
+    enc->len = 0;
+    enc->seq = 0;
+    frame_encoder_set_max(enc, max_payload);
+}
+
+void frame_encoder_set_max(frame_encoder_t *enc, size_t max_payload) {
+    if (max_payload < 1) {
+        max_payload = 1;
+    } else if (max_payload > FRAME_MAX_PAYLOAD) {
+        max_payload = FRAME_MAX_PAYLOAD;
+    }
+    enc->max_payload = max_payload;
+}
+
+bool frame_encoder_add(frame_encoder_t *enc, const uint8_t *data, size_t len) {
+    if (enc->len + len > enc->max_payload) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        enc->raw[1 + enc->len + i] = data[i];
+    }
+    enc->len += len;
+    return true;
+}
+
+size_t frame_encoder_flush(frame_encoder_t *enc, uint8_t *out) {
+    if (enc->len == 0) {
+        return 0;
+    }
+    size_t raw_len = 1 + enc->len;
+    enc->raw[0] = enc->seq++;
+    uint16_t crc = frame_crc16(0xFFFF, enc->raw, raw_len);
+    enc->raw[raw_len++] = crc & 0xFF;
+    enc->raw[raw_len++] = crc >> 8;
+
+    size_t n = cobs_encode(enc->raw, raw_len, out);
+    out[n++] = 0;
+    enc->len = 0;
+    return n;
+}
+
+void frame_decoder_init(frame_decoder_t *dec, frame_rx_cb_t cb, void *ctx) {
+    dec->len = 0;
+    dec->overlong = false;
+    dec->synced = false;
+    dec->next_seq = 0;
+    dec->cb = cb;
+    dec->ctx = ctx;
+    dec->frames = 0;
+    dec->crc_errors = 0;
+    dec->bad_frames = 0;
+    dec->lost_frames = 0;
+    dec->resyncs = 0;
+}
+
+static void frame_decoder_finish(frame_decoder_t *dec) {
+    size_t len;
+    // A frame that encodes to at most sizeof(buf) can still decode to more
+    // than FRAME_MAX_RAW, and callers size their buffers for the limit
+    if (dec->overlong || !cobs_decode(dec->buf, dec->len, dec->buf, &len) || len < 3 ||
+        len > FRAME_MAX_RAW) {
+        dec->bad_frames++;
+        return;
+    }
+
+    uint16_t crc = dec->buf[len - 2] | (dec->buf[len - 1] << 8);
+    if (frame_crc16(0xFFFF, dec->buf, len - 2) != crc) {
+        dec->crc_errors++;
+        return;
+    }
+
+    // A jump of more than half the sequence space is taken as going back:
+    // follow the new numbering rather than count ~255 lost frames
+    uint8_t seq = dec->buf[0];
+    uint8_t gap = seq - dec->next_seq;
+    if (dec->synced && gap > 127) {
+        dec->resyncs++;
+    } else if (dec->synced) {
+        dec->lost_frames += gap;
+    }
+    dec->synced = true;
+    dec->next_seq = seq + 1;
+    dec->frames++;
+
+    if (dec->cb) {
+        dec->cb(seq, dec->buf + 1, len - 3, dec->ctx);
+    }
+}
+
+void frame_decoder_push(frame_decoder_t *dec, const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = data[i];
+        if (c == 0) {
+            if (dec->len > 0 || dec->overlong) {
+                frame_decoder_finish(dec);
+            }
+            dec->len = 0;
+            dec->overlong = false;
+        } else if (dec->len < sizeof(dec->buf)) {
+            dec->buf[dec->len++] = c;
+        } else {
+            dec->overlong = true;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Framed UART protocol. On the wire a frame is
+//   COBS(seq, payload..., crc16 lo, crc16 hi) 0x00
+// where crc16 is CRC-16/CCITT-FALSE over seq and payload. The payload holds
+// one or more batched events.
+
+// Largest payload per frame. Keeps the raw frame within one COBS block.
+#define FRAME_MAX_PAYLOAD 251
+#define FRAME_MAX_RAW (FRAME_MAX_PAYLOAD + 3)
+// Worst case COBS output plus the 0x00 delimiter
+#define FRAME_MAX_ENCODED (FRAME_MAX_RAW + FRAME_MAX_RAW / 254 + 2)
+
+uint16_t frame_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+typedef struct {
+    uint8_t raw[FRAME_MAX_RAW]; // seq, then payload; crc appended on flush
+    size_t len;                 // payload bytes pending
+    size_t max_payload;
+    uint8_t seq;
+} frame_encoder_t;
+
+void frame_encoder_init(frame_encoder_t *enc, size_t max_payload);
+
+// Limit the batch size, clamped to 1..FRAME_MAX_PAYLOAD
+void frame_encoder_set_max(frame_encoder_t *enc, size_t max_payload);
+
+// Append an event to the pending frame. Returns false, without adding
+// anything, if it doesn't fit; flush and try again.
+bool frame_encoder_add(frame_encoder_t *enc, const uint8_t *data, size_t len);
+
+static inline size_t frame_encoder_pending(const frame_encoder_t *enc) {
+    return enc->len;
+}
+
+// Encode the pending frame, delimiter included, into out (at least
+// FRAME_MAX_ENCODED bytes). Returns the encoded length, 0 if nothing pending.
+size_t frame_encoder_flush(frame_encoder_t *enc, uint8_t *out);
+
+typedef void (*frame_rx_cb_t)(uint8_t seq, const uint8_t *payload, size_t len, void *ctx);
+
+typedef struct {
+    uint8_t buf[FRAME_MAX_ENCODED - 1]; // one valid frame, delimiter not stored
+    size_t len;
+    bool overlong;   // current frame outgrew buf, drop it at the delimiter
+    bool synced;     // next_seq is valid
+    uint8_t next_seq;
+    frame_rx_cb_t cb;
+    void *ctx;
+
+    uint32_t frames;      // good frames delivered
+    uint32_t crc_errors;
+    uint32_t bad_frames;  // COBS errors, too short or too long
+    uint32_t lost_frames; // frames skipped by forward jumps in seq, up to 127
+    uint32_t resyncs;     // backward jumps: a duplicate, a reordered frame or a peer restart
+} frame_decoder_t;
+
+void frame_decoder_init(frame_decoder_t *dec, frame_rx_cb_t cb, void *ctx);
+
+// Feed received bytes, cb is called for every good frame
+void frame_decoder_push(frame_decoder_t *dec, const uint8_t *data, size_t len);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef HAL_H
+#define HAL_H
+
+// Thin hardware layer used by the application code so it builds both for the
+// Pico (hal_pico.c) and for a Linux host (hal_host.c).
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Time
+
+uint64_t hal_time_us(void);
+
+// Same contract as the SDK's alarm_callback_t: return 0 to stop, >0 to fire
+// again that many us from now, <0 to fire again that many us after the
+// previous deadline (drift free).
+typedef int64_t (*hal_alarm_cb_t)(int32_t id, void *user_data);
+
+// Callback runs in IRQ context on the Pico. Returns false if no alarm was free.
+bool hal_alarm_in_us(uint64_t us, hal_alarm_cb_t cb, void *user_data);
+
+// Sleep until something (an IRQ, alarm or input) may have work for the loop
+void hal_wait_for_event(void);
+
+// Mask IRQ-context callbacks around a short critical section
+uint32_t hal_irq_save(void);
+void hal_irq_restore(uint32_t state);
+
+// GPIO
+
+typedef void (*hal_gpio_irq_cb_t)(uint32_t pin);
+
+// Input with pull-up, on_edge called on both edges (IRQ context on the Pico)
+void hal_gpio_init_button(uint32_t pin, hal_gpio_irq_cb_t on_edge);
+bool hal_gpio_get(uint32_t pin);
+
+// UART
+
+typedef void (*hal_uart_rx_cb_t)(uint32_t port, uint8_t c, bool fifo_overrun);
+typedef void (*hal_uart_tx_done_cb_t)(uint32_t port);
+
+// Once per port, from thread context (claims the port's TX DMA channel on the Pico)
+void hal_uart_init(uint32_t port, uint32_t baud, uint32_t tx_pin, uint32_t rx_pin);
+
+// Change the baud rate of a running UART, returns the rate actually set
+uint32_t hal_uart_set_baud(uint32_t port, uint32_t baud);
+
+// Called for every received byte, from the RX IRQ on the Pico. The IRQ is
+// serviced on the core that makes this call. Ports with a handler are
+// serviced round robin so a saturated port can't starve the others.
+void hal_uart_set_rx_handler(uint32_t port, hal_uart_rx_cb_t on_rx);
+
+// Send len bytes from buf in the background (DMA on the Pico). on_done runs,
+// in IRQ context on the Pico, once buf is no longer needed. Only one transfer
+// per port may be in flight.
+void hal_uart_tx_start(uint32_t port, const uint8_t *buf, size_t len, hal_uart_tx_done_cb_t on_done);
+
+// Logging
+
+// Bytes hal_log_write() can take right now without blocking: 0 while no USB
+// host is attached, or while the host isn't reading and the CDC buffer is full
+size_t hal_log_space(void);
+
+// Bytes hal_log_write() sends for each '\n' it is given: 2 on the Pico, whose
+// USB stdio sends "\r\n"
+size_t hal_log_eol_len(void);
+
+// Blocks (up to the stdio timeout on the Pico) if len exceeds hal_log_space()
+void hal_log_write(const char *buf, size_t len);
+
+// Next char typed on the log console (USB CDC on the Pico), -1 if none
+int hal_log_getc(void);
+
+#endif
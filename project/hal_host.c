@@ -0,0 +1,346 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "hal_host.h"
+#include "ring_buf.h"
+
+// Each UART is a PTY pair: the firmware side uses the master, a peer (or a
+// benchmark) opens the slave. Alarms, RX data and scripted button edges are
+// all dispatched from hal_wait_for_event() on the calling thread, which plays
+// the part of the Pico's IRQ handlers.
+
+#define HOST_UART_PORTS 2
+#define HOST_UART_RX_BURST 16 // bytes per port per round, like the Pico's half FIFO
+#define HOST_UART_RX_MAX 256  // bytes per port per wait
+#define HOST_ALARMS 16
+#define HOST_GPIO_PINS 32
+#define HOST_SCRIPT_STEPS 4096
+
+typedef struct {
+    int master;
+    int slave; // held open so the master never sees a hangup
+    char name[64];
+    hal_uart_rx_cb_t on_rx;
+    const uint8_t *tx_buf; // rest of the transfer in flight
+    size_t tx_len;
+    hal_uart_tx_done_cb_t tx_done;
+} host_uart_t;
+
+typedef struct {
+    hal_alarm_cb_t cb; // NULL when the slot is free
+    void *user_data;
+    uint64_t target_us;
+} host_alarm_t;
+
+typedef struct {
+    uint64_t time_us;
+    bool level;
+} host_step_t;
+
+static host_uart_t host_uart[HOST_UART_PORTS] = {{-1, -1}, {-1, -1}};
+static host_alarm_t host_alarm[HOST_ALARMS];
+static bool gpio_level[HOST_GPIO_PINS];
+static uint32_t btn_pin = HOST_GPIO_PINS;
+static hal_gpio_irq_cb_t gpio_edge_cb;
+static host_step_t script[HOST_SCRIPT_STEPS];
+static size_t script_len;
+static size_t script_pos;
+static bool console_open = true; // stdin stands in for the USB CDC console
+static uint8_t console_storage[256];
+static ring_buf_t console_in = {console_storage, sizeof(console_storage) - 1};
+
+uint64_t hal_time_us(void) {
+    static uint64_t epoch_us;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t now = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (!epoch_us) {
+        epoch_us = now;
+    }
+    return now - epoch_us;
+}
+
+bool hal_alarm_in_us(uint64_t us, hal_alarm_cb_t cb, void *user_data) {
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        if (!host_alarm[i].cb) {
+            host_alarm[i].cb = cb;
+            host_alarm[i].user_data = user_data;
+            host_alarm[i].target_us = hal_time_us() + us;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void host_fire_alarm(int i, uint64_t now) {
+    host_alarm_t *a = &host_alarm[i];
+    int64_t next = a->cb(i + 1, a->user_data);
+    if (next < 0) {
+        a->target_us += -next;
+    } else if (next > 0) {
+        a->target_us = now + next;
+    } else {
+        a->cb = NULL;
+    }
+}
+
+static void host_apply_step(void) {
+    bool level = script[script_pos++].level;
+    if (btn_pin < HOST_GPIO_PINS && gpio_level[btn_pin] != level) {
+        gpio_level[btn_pin] = level;
+        if (gpio_edge_cb) {
+            gpio_edge_cb(btn_pin);
+        }
+    }
+}
+
+// Run the script steps and alarms due by now in the order they were due, so
+// a late wakeup doesn't let an edge overtake an alarm that was due before it
+static void host_run_due(uint64_t now) {
+    for (;;) {
+        int first = -1;
+        for (int i = 0; i < HOST_ALARMS; i++) {
+            if (host_alarm[i].cb && host_alarm[i].target_us <= now &&
+                (first < 0 || host_alarm[i].target_us < host_alarm[first].target_us)) {
+                first = i;
+            }
+        }
+        bool step = script_pos < script_len && script[script_pos].time_us <= now;
+        if (step && (first < 0 || script[script_pos].time_us <= host_alarm[first].target_us)) {
+            host_apply_step();
+        } else if (first >= 0) {
+            host_fire_alarm(first, now);
+        } else {
+            return;
+        }
+    }
+}
+
+// Write as much of the port's transfer in flight as the PTY takes. Once it
+// has all gone, tell the owner.
+static void host_uart_tx_continue(uint32_t port) {
+    host_uart_t *u = &host_uart[port];
+    while (u->tx_len > 0) {
+        ssize_t n = write(u->master, u->tx_buf, u->tx_len);
+        if (n < 0) {
+            if (errno == EAGAIN) {
+                return; // the peer is behind, carry on at POLLOUT
+            }
+            perror("uart write");
+            break;
+        }
+        u->tx_buf += n;
+        u->tx_len -= n;
+    }
+    u->tx_len = 0;
+    hal_uart_tx_done_cb_t done = u->tx_done;
+    u->tx_done = NULL;
+    done(port);
+}
+
+void hal_wait_for_event(void) {
+    uint64_t now = hal_time_us();
+    uint64_t deadline = UINT64_MAX;
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        if (host_alarm[i].cb && host_alarm[i].target_us < deadline) {
+            deadline = host_alarm[i].target_us;
+        }
+    }
+    if (script_pos < script_len && script[script_pos].time_us < deadline) {
+        deadline = script[script_pos].time_us;
+    }
+
+    struct pollfd fds[HOST_UART_PORTS + 1];
+    uint32_t ports[HOST_UART_PORTS];
+    nfds_t nfds = 0;
+    for (uint32_t p = 0; p < HOST_UART_PORTS; p++) {
+        short events = (host_uart[p].on_rx ? POLLIN : 0) | (host_uart[p].tx_len ? POLLOUT : 0);
+        if (events) {
+            fds[nfds].fd = host_uart[p].master;
+            fds[nfds].events = events;
+            ports[nfds++] = p;
+        }
+    }
+
+    nfds_t uart_fds = nfds;
+    if (console_open) {
+        fds[nfds].fd = STDIN_FILENO;
+        fds[nfds++].events = POLLIN;
+    }
+
+    if (nfds == 0 && deadline == UINT64_MAX) {
+        return; // nothing could ever wake us
+    }
+
+    struct timespec timeout;
+    if (deadline != UINT64_MAX) {
+        uint64_t wait = deadline > now ? deadline - now : 0;
+        timeout.tv_sec = wait / 1000000;
+        timeout.tv_nsec = (wait % 1000000) * 1000;
+    }
+    if (ppoll(fds, nfds, deadline == UINT64_MAX ? NULL : &timeout, NULL) > 0) {
+        if (nfds > uart_fds && fds[uart_fds].revents) {
+            uint8_t buf[64];
+            ssize_t n = read(STDIN_FILENO, buf, ring_buf_free(&console_in) < sizeof(buf) ?
+                             ring_buf_free(&console_in) : sizeof(buf));
+            if (n <= 0 && ring_buf_free(&console_in) > 0) {
+                console_open = false; // EOF, stop polling it
+            }
+            for (ssize_t j = 0; j < n; j++) {
+                ring_buf_put(&console_in, buf[j]);
+            }
+        }
+        for (nfds_t i = 0; i < uart_fds; i++) {
+            if (fds[i].revents & POLLOUT) {
+                host_uart_tx_continue(ports[i]);
+            }
+        }
+
+        // Round robin over the ready ports, a burst each, as the Pico
+        // dispatcher does
+        bool more = true;
+        for (int total = 0; more && total < HOST_UART_RX_MAX; total += HOST_UART_RX_BURST) {
+            more = false;
+            for (nfds_t i = 0; i < uart_fds; i++) {
+                if (!(fds[i].revents & POLLIN)) {
+                    continue;
+                }
+                host_uart_t *u = &host_uart[ports[i]];
+                uint8_t buf[HOST_UART_RX_BURST];
+                ssize_t n = read(u->master, buf, sizeof(buf));
+                for (ssize_t j = 0; j < n; j++) {
+                    u->on_rx(ports[i], buf[j], false);
+                }
+                if (n < (ssize_t)sizeof(buf)) {
+                    fds[i].revents &= ~POLLIN; // drained
+                } else {
+                    more = true;
+                }
+            }
+        }
+    }
+
+    host_run_due(hal_time_us());
+}
+
+uint32_t hal_irq_save(void) {
+    return 0; // every callback already runs on the loop thread
+}
+
+void hal_irq_restore(uint32_t state) {
+}
+
+void hal_gpio_init_button(uint32_t pin, hal_gpio_irq_cb_t on_edge) {
+    if (pin >= HOST_GPIO_PINS) {
+        return;
+    }
+    btn_pin = pin;
+    gpio_edge_cb = on_edge;
+    gpio_level[pin] = true; // pulled up
+}
+
+bool hal_gpio_get(uint32_t pin) {
+    return pin < HOST_GPIO_PINS && gpio_level[pin];
+}
+
+bool hal_host_load_button_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    char line[128];
+    script_len = 0;
+    script_pos = 0;
+    while (fgets(line, sizeof(line), f) && script_len < HOST_SCRIPT_STEPS) {
+        unsigned long long t;
+        int level;
+        if (line[0] == '#' || sscanf(line, "%llu %d", &t, &level) != 2) {
+            continue;
+        }
+        script[script_len].time_us = t;
+        script[script_len].level = level != 0;
+        script_len++;
+    }
+    fclose(f);
+    return true;
+}
+
+void hal_uart_init(uint32_t port, uint32_t baud, uint32_t tx_pin, uint32_t rx_pin) {
+    if (port >= HOST_UART_PORTS || host_uart[port].master >= 0) {
+        return;
+    }
+    host_uart_t *u = &host_uart[port];
+
+    u->master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (u->master < 0 || grantpt(u->master) || unlockpt(u->master) ||
+        ptsname_r(u->master, u->name, sizeof(u->name))) {
+        perror("pty");
+        exit(1);
+    }
+    u->slave = open(u->name, O_RDWR | O_NOCTTY);
+
+    // Raw bytes both ways, like a real UART
+    struct termios tio;
+    if (u->slave >= 0 && tcgetattr(u->slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(u->slave, TCSANOW, &tio);
+    }
+    fcntl(u->master, F_SETFL, fcntl(u->master, F_GETFL) | O_NONBLOCK);
+
+    fprintf(stderr, "uart%u: %s (%u baud)\n", port, u->name, baud);
+}
+
+void hal_uart_set_rx_handler(uint32_t port, hal_uart_rx_cb_t on_rx) {
+    if (port < HOST_UART_PORTS) {
+        host_uart[port].on_rx = on_rx;
+    }
+}
+
+uint32_t hal_uart_set_baud(uint32_t port, uint32_t baud) {
+    return baud; // a PTY runs at whatever speed the reader keeps up with
+}
+
+void hal_uart_tx_start(uint32_t port, const uint8_t *buf, size_t len, hal_uart_tx_done_cb_t on_done) {
+    if (port >= HOST_UART_PORTS || host_uart[port].master < 0) {
+        on_done(port);
+        return;
+    }
+    // Whatever the PTY doesn't take now stays in flight until the peer
+    // reads, so the TX queue behind it fills and counts drops as on the Pico
+    host_uart_t *u = &host_uart[port];
+    u->tx_buf = buf;
+    u->tx_len = len;
+    u->tx_done = on_done;
+    host_uart_tx_continue(port);
+}
+
+const char *hal_host_uart_pty(uint32_t port) {
+    return port < HOST_UART_PORTS && host_uart[port].master >= 0 ? host_uart[port].name : NULL;
+}
+
+size_t hal_log_space(void) {
+    return SIZE_MAX; // stdout may block, like a host that reads slowly
+}
+
+size_t hal_log_eol_len(void) {
+    return 1;
+}
+
+void hal_log_write(const char *buf, size_t len) {
+    fwrite(buf, 1, len, stdout);
+    fflush(stdout);
+}
+
+int hal_log_getc(void) {
+    uint8_t c;
+    return ring_buf_get(&console_in, &c) ? c : -1;
+}
@@ -0,0 +1,17 @@
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Linux-only extras for hal_host.c
+
+// Load a button script: one "<time_us> <level>" step per line, times from
+// program start, level 1 released / 0 pressed, '#' starts a comment. Steps
+// are applied to the pin passed to hal_gpio_init_button().
+bool hal_host_load_button_script(const char *path);
+
+// Path of the PTY slave standing in for a UART, NULL if not initialised
+const char *hal_host_uart_pty(uint32_t port);
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include "hal.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+#include "tusb.h"
+
+// Bytes taken from one port before moving on to the next, half the RX FIFO
+#define HAL_UART_RX_BURST 16
+
+static hal_gpio_irq_cb_t gpio_edge_cb;
+static hal_uart_rx_cb_t uart_rx_cb[2];
+static int uart_tx_dma[2] = {-1, -1};
+static hal_uart_tx_done_cb_t uart_tx_done_cb[2];
+
+uint64_t hal_time_us(void) {
+    return time_us_64();
+}
+
+bool hal_alarm_in_us(uint64_t us, hal_alarm_cb_t cb, void *user_data) {
+    return add_alarm_in_us(us, cb, user_data, true) >= 0;
+}
+
+void hal_wait_for_event(void) {
+    __wfe();
+}
+
+uint32_t hal_irq_save(void) {
+    return save_and_disable_interrupts();
+}
+
+void hal_irq_restore(uint32_t state) {
+    restore_interrupts(state);
+}
+
+static void hal_gpio_irq(uint gpio, uint32_t events) {
+    if (gpio_edge_cb) {
+        gpio_edge_cb(gpio);
+    }
+}
+
+void hal_gpio_init_button(uint32_t pin, hal_gpio_irq_cb_t on_edge) {
+    gpio_edge_cb = on_edge;
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+    gpio_set_pulls(pin, true, false);
+    gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE,
+                                       true, hal_gpio_irq);
+}
+
+bool hal_gpio_get(uint32_t pin) {
+    return gpio_get(pin);
+}
+
+static void hal_uart_dma_irq(void);
+
+void hal_uart_init(uint32_t port, uint32_t baud, uint32_t tx_pin, uint32_t rx_pin) {
+    uart_inst_t *uart = uart_get_instance(port);
+    uart_init(uart, baud);
+    //uart_set_format(uart, 8, 1, UART_PARITY_NONE);
+    gpio_set_function(tx_pin, GPIO_FUNC_UART);
+    gpio_set_function(rx_pin, GPIO_FUNC_UART);
+
+    // TX DMA channel paced by the TX FIFO, started by hal_uart_tx_start()
+    int chan = dma_claim_unused_channel(true);
+    dma_channel_config cfg = dma_channel_get_default_config(chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, uart_get_dreq(uart, true));
+    dma_channel_configure(chan, &cfg, &uart_get_hw(uart)->dr, NULL, 0, false);
+    dma_channel_set_irq1_enabled(chan, true);
+    uart_tx_dma[port] = chan;
+
+    // One handler serves every port's channel
+    static bool dma_irq_added;
+    if (!dma_irq_added) {
+        irq_add_shared_handler(DMA_IRQ_1, hal_uart_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+        dma_irq_added = true;
+    }
+}
+
+uint32_t hal_uart_set_baud(uint32_t port, uint32_t baud) {
+    // Up to clk_peri / 16, several Mbaud
+    return uart_set_baudrate(uart_get_instance(port), baud);
+}
+
+// Both UART IRQs land here. Take up to a burst from each port in turn until
+// every FIFO is empty, so the next IRQ only fires for new data and a port at
+// full rate can't hold off the other one.
+static void hal_uart_irq(void) {
+    bool more;
+    do {
+        more = false;
+        for (uint32_t port = 0; port < 2; port++) {
+            if (!uart_rx_cb[port]) {
+                continue;
+            }
+            uart_hw_t *hw = uart_get_hw(uart_get_instance(port));
+            for (int i = 0; i < HAL_UART_RX_BURST && !(hw->fr & UART_UARTFR_RXFE_BITS); i++) {
+                uint32_t dr = hw->dr;
+                uart_rx_cb[port](port, (uint8_t)dr, dr & UART_UARTDR_OE_BITS);
+            }
+            if (!(hw->fr & UART_UARTFR_RXFE_BITS)) {
+                more = true;
+            }
+        }
+    } while (more);
+}
+
+void hal_uart_set_rx_handler(uint32_t port, hal_uart_rx_cb_t on_rx) {
+    uart_rx_cb[port] = on_rx;
+
+    uint irq = port ? UART1_IRQ : UART0_IRQ;
+    irq_set_exclusive_handler(irq, hal_uart_irq);
+    irq_set_enabled(irq, true);
+
+    // Interrupt at half full, and on the receive timeout so a short burst
+    // that never reaches the threshold is still picked up
+    uart_hw_t *hw = uart_get_hw(uart_get_instance(port));
+    hw_write_masked(&hw->ifls, 2 << UART_UARTIFLS_RXIFLSEL_LSB, UART_UARTIFLS_RXIFLSEL_BITS);
+    hw_set_bits(&hw->imsc, UART_UARTIMSC_RXIM_BITS | UART_UARTIMSC_RTIM_BITS);
+}
+
+static void hal_uart_dma_irq(void) {
+    for (uint32_t port = 0; port < 2; port++) {
+        int chan = uart_tx_dma[port];
+        if (chan >= 0 && dma_channel_get_irq1_status(chan)) {
+            dma_channel_acknowledge_irq1(chan);
+            uart_tx_done_cb[port](port);
+        }
+    }
+}
+
+void hal_uart_tx_start(uint32_t port, const uint8_t *buf, size_t len, hal_uart_tx_done_cb_t on_done) {
+    uart_tx_done_cb[port] = on_done;
+    dma_channel_transfer_from_buffer_now(uart_tx_dma[port], buf, len);
+}
+
+size_t hal_log_space(void) {
+    // A host can hold DTR without reading, so connected isn't enough
+    return stdio_usb_connected() ? tud_cdc_write_available() : 0;
+}
+
+size_t hal_log_eol_len(void) {
+    // stdio translates '\n' to "\r\n" on every driver unless built without it
+    return PICO_STDIO_ENABLE_CRLF_SUPPORT && PICO_STDIO_DEFAULT_CRLF ? 2 : 1;
+}
+
+void hal_log_write(const char *buf, size_t len) {
+    printf("%.*s", (int)len, buf);
+}
+
+int hal_log_getc(void) {
+    int c = getchar_timeout_us(0);
+    return c == PICO_ERROR_TIMEOUT ? -1 : c;
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "app.h"
+#include "frame.h"
+#include "hal.h"
+#include "hal_host.h"
+#include "log.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+#if UDP_BRIDGE_HOST
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+#include "lwip/udp.h"
+#include "udp_bridge.h"
+#endif
+
+// Runs the firmware logic on Linux. Each UART in the port table is a PTY (the
+// paths are printed on start-up) and the button follows an optional script,
+// see hal_host.h. -m, -B and -f apply to every port.
+//
+// usage: main_host [-b button_script] [-d duration_ms] [-m legacy|framed]
+//                  [-B baud] [-f frame_payload] [-u udp_port]
+//
+// With -u (builds with LWIP_DIR only) UART1 is bridged over lwIP's loopback
+// interface to an in-process UDP echo on udp_port + 1, so whatever is written
+// to the PTY comes back through the bridge.
+
+#if UDP_BRIDGE_HOST
+static void echo_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                      const ip_addr_t *addr, u16_t port) {
+    udp_sendto(pcb, p, addr, port);
+    pbuf_free(p);
+}
+
+static bool bridge_start(uint16_t port) {
+    lwip_init(); // brings up the 127.0.0.1 loopback interface
+
+    struct udp_pcb *echo = udp_new();
+    if (!echo || udp_bind(echo, IP_ADDR_ANY, port + 1) != ERR_OK) {
+        return false;
+    }
+    udp_recv(echo, echo_recv, NULL);
+
+    ip_addr_t peer;
+    ip_addr_set_loopback(false, &peer);
+    if (!udp_bridge_init(APP_UART, &peer, port + 1, port)) {
+        return false;
+    }
+    app_set_rx_tap(udp_bridge_feed);
+    return true;
+}
+#endif
+
+int main(int argc, char **argv) {
+    uint64_t duration_us = 0;
+    uart_port_mode_t mode = UART_PORT_LEGACY;
+    uint32_t baud = 9600;
+    uint32_t frame_payload = FRAME_MAX_PAYLOAD;
+    uint16_t bridge_port = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:d:m:B:f:u:")) != -1) {
+        switch (opt) {
+            case 'b':
+                if (!hal_host_load_button_script(optarg)) {
+                    return 1;
+                }
+                break;
+            case 'd':
+                duration_us = strtoull(optarg, NULL, 0) * 1000;
+                break;
+            case 'm':
+                mode = strcmp(optarg, "framed") == 0 ? UART_PORT_FRAMED : UART_PORT_LEGACY;
+                break;
+            case 'B':
+                baud = strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                frame_payload = strtoul(optarg, NULL, 0);
+                break;
+            case 'u':
+                bridge_port = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-b button_script] [-d duration_ms] [-m legacy|framed] "
+                        "[-B baud] [-f frame_payload] [-u udp_port]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    hal_time_us(); // start the clock the button script is timed against
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        uart_ports[port].baud = baud;
+    }
+    uart_ports_init();
+    app_init(true);
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        app_set_link(port, mode, baud, frame_payload);
+    }
+
+    if (bridge_port) {
+#if UDP_BRIDGE_HOST
+        if (!bridge_start(bridge_port)) {
+            fprintf(stderr, "UDP bridge init failed\n");
+            return 1;
+        }
+#else
+        fprintf(stderr, "-u needs a build with -DLWIP_DIR\n");
+        return 1;
+#endif
+    }
+
+    while (!duration_us || hal_time_us() < duration_us) {
+        bool busy = app_poll();
+#if UDP_BRIDGE_HOST
+        if (bridge_port) {
+            udp_bridge_poll();
+            netif_poll_all(); // deliver what the loopback interface queued
+            sys_check_timeouts();
+        }
+#endif
+        if (!busy) {
+            hal_wait_for_event();
+        }
+    }
+
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        if (uart_ports[port].mode == UART_PORT_OFF) {
+            continue;
+        }
+        uart_rx_stats_t stats;
+        uart_rx_get_stats(port, &stats);
+        fprintf(stderr, "uart%u rx: %u bytes, %u overflows, %u fifo overruns, high water %u, "
+                "tx %u bytes, tx dropped %u\n",
+                port, stats.received, stats.overflows, stats.fifo_overruns, stats.high_water,
+                uart_tx_bytes(port), uart_tx_dropped(port));
+    }
+    fprintf(stderr, "log dropped %u\n", log_dropped());
+#if UDP_BRIDGE_HOST
+    if (bridge_port) {
+        udp_bridge_stats_t bs;
+        udp_bridge_get_stats(&bs);
+        fprintf(stderr, "bridge: tx %u datagrams %u bytes %u dropped %u late, "
+                "rx %u datagrams %u bytes %u dropped\n",
+                bs.tx_datagrams, bs.tx_bytes, bs.tx_dropped, bs.tx_late,
+                bs.rx_datagrams, bs.rx_bytes, bs.rx_dropped);
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+#include "log.h"
+#include "hal.h"
+#include "stats.h"
+
+#if (LOG_RING_SIZE & (LOG_RING_SIZE - 1)) != 0
+#error "LOG_RING_SIZE must be a power of two"
+#endif
+
+static log_record_t log_ring[LOG_RING_SIZE];
+static volatile uint32_t log_head; // producers
+static volatile uint32_t log_tail; // log_drain only
+static volatile uint32_t log_drop_count;
+static uint32_t log_drop_reported;
+
+void log_init(void) {
+    log_head = 0;
+    log_tail = 0;
+    log_drop_count = 0;
+    log_drop_reported = 0;
+}
+
+void log_event(log_event_t event, uint8_t port, uint8_t data) {
+    uint32_t now = (uint32_t)hal_time_us();
+
+    // IRQ handlers also log, so claim the slot with interrupts masked.
+    // The M0+ has no exclusive loads; this is a handful of cycles.
+    uint32_t save = hal_irq_save();
+    uint32_t head = log_head;
+    if (head - log_tail >= LOG_RING_SIZE) {
+        log_drop_count++;
+    } else {
+        log_record_t *rec = &log_ring[head & (LOG_RING_SIZE - 1)];
+        rec->time_us = now;
+        rec->event = event;
+        rec->port = port;
+        rec->data = data;
+        log_head = head + 1;
+    }
+    hal_irq_restore(save);
+}
+
+// Longest line log_format() produces, terminator included
+#define LOG_LINE_MAX 48
+
+static int log_format(char *buf, size_t len, const log_record_t *rec) {
+    unsigned long s = rec->time_us / 1000000, us = rec->time_us % 1000000;
+    switch (rec->event) {
+        case LOG_EVT_SENT:
+            return snprintf(buf, len, "[%lu.%06lu] uart%u Sent: %c\n", s, us, rec->port, rec->data);
+        case LOG_EVT_RECEIVED:
+            return snprintf(buf, len, "[%lu.%06lu] uart%u Received: %c\n", s, us, rec->port, rec->data);
+        case LOG_EVT_RX_IDLE:
+            return snprintf(buf, len, "[%lu.%06lu] UART not readable\n", s, us);
+        default:
+            return snprintf(buf, len, "[%lu.%06lu] uart%u Event %u: %02x\n", s, us, rec->port,
+                            rec->event, rec->data);
+    }
+}
+
+bool log_drain(void) {
+    // Only write what the output takes without blocking, leave the rest queued.
+    // Lines are budgeted as sent, with the '\n' expanded by the output.
+    size_t space = hal_log_space();
+    if (space == 0) {
+        return false;
+    }
+
+    char out[LOG_DRAIN_BATCH * LOG_LINE_MAX + LOG_LINE_MAX];
+    size_t eol_extra = hal_log_eol_len() - 1;
+    size_t used = 0;
+    size_t sent = 0; // used, as the output will send it
+    uint32_t tail = log_tail;
+    uint32_t head = log_head;
+
+    // The drop report goes first so it is never starved by new records
+    uint32_t dropped = log_drop_count;
+    if (dropped != log_drop_reported) {
+        char line[LOG_LINE_MAX];
+        int n = snprintf(line, sizeof(line), "Log dropped: %lu\n",
+                         (unsigned long)(dropped - log_drop_reported));
+        if (n + eol_extra <= space) {
+            memcpy(out, line, n);
+            used = n;
+            sent = n + eol_extra;
+            log_drop_reported = dropped;
+        }
+    }
+
+    for (int i = 0; i < LOG_DRAIN_BATCH && tail != head; i++, tail++) {
+        char line[LOG_LINE_MAX];
+        int n = log_format(line, sizeof(line), &log_ring[tail & (LOG_RING_SIZE - 1)]);
+        if (sent + n + eol_extra > space) {
+            break;
+        }
+        memcpy(out + used, line, n);
+        used += n;
+        sent += n + eol_extra;
+    }
+    log_tail = tail;
+
+    if (used == 0) {
+        return false; // not even one line fits, wait for the host to read
+    }
+    uint64_t start = hal_time_us();
+    hal_log_write(out, used);
+    stats_record(STATS_LOG_DRAIN, (uint32_t)(hal_time_us() - start));
+    return tail != log_head;
+}
+
+uint32_t log_dropped(void) {
+    return log_drop_count;
+}
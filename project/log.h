@@ -0,0 +1,44 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Number of records the log ring holds, must be a power of two
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 256
+#endif
+
+// Records formatted per log_drain() call
+#ifndef LOG_DRAIN_BATCH
+#define LOG_DRAIN_BATCH 16
+#endif
+
+typedef enum {
+    LOG_EVT_SENT,     // data: byte written to the UART
+    LOG_EVT_RECEIVED, // data: byte after the RX transform
+    LOG_EVT_RX_IDLE,  // a TX period passed with nothing received on any port
+} log_event_t;
+
+typedef struct {
+    uint32_t time_us;
+    uint8_t event;
+    uint8_t port; // UART the event happened on
+    uint8_t data;
+} log_record_t;
+
+void log_init(void);
+
+// Queue a record. Safe from IRQ and thread context, never blocks; the record
+// is counted as dropped if the ring is full.
+void log_event(log_event_t event, uint8_t port, uint8_t data);
+
+// Format up to LOG_DRAIN_BATCH records and write them out in one go.
+// Writes only whole lines that fit in hal_log_space(). Call from the main loop.
+// Returns true if it wrote something and records are still waiting, false
+// once the queue is empty or the output has no room for the next line.
+bool log_drain(void);
+
+uint32_t log_dropped(void);
+
+#endif
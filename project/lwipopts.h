@@ -0,0 +1,49 @@
+#ifndef _LWIPOPTS_H
+#define _LWIPOPTS_H
+
+// lwIP settings for the UART/UDP bridge, see udp_bridge.h. Used both with the
+// cyw43 arch on the Pico and with lwIP's Unix port in the host build.
+
+#define NO_SYS                      1
+#define LWIP_SOCKET                 0
+#define LWIP_NETCONN                0
+#define MEM_LIBC_MALLOC             0
+#define MEM_ALIGNMENT               4
+#define MEMP_NUM_ARP_QUEUE          10
+#define LWIP_ARP                    1
+#define LWIP_ETHERNET               1
+#define LWIP_ICMP                   1
+#define LWIP_RAW                    1
+#define LWIP_IPV4                   1
+#define LWIP_UDP                    1
+#define LWIP_TCP                    1
+#define TCP_MSS                     1460
+#define TCP_WND                     (8 * TCP_MSS)
+#define TCP_SND_BUF                 (8 * TCP_MSS)
+#define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
+#define MEMP_NUM_TCP_SEG            32
+#define LWIP_NETIF_STATUS_CALLBACK  1
+#define LWIP_NETIF_LINK_CALLBACK    1
+#define LWIP_NETIF_HOSTNAME         1
+#define LWIP_NETIF_TX_SINGLE_PBUF   1
+#define LWIP_CHKSUM_ALGORITHM       3
+#define LWIP_STATS                  0
+#define LWIP_STATS_DISPLAY          0
+
+#ifdef LIB_PICO_CYW43_ARCH
+#define MEM_SIZE                    8000
+#define PBUF_POOL_SIZE              24
+#define LWIP_DHCP                   1
+#define DHCP_DOES_ARP_CHECK         0
+#define LWIP_DHCP_DOES_ACD_CHECK    0
+#else
+// Host: everything goes over the loopback interface, polled from the main loop
+#define MEM_SIZE                    (256 * 1024)
+#define PBUF_POOL_SIZE              64
+#define LWIP_DHCP                   0
+#define LWIP_HAVE_LOOPIF            1
+#define LWIP_NETIF_LOOPBACK         1
+#define LWIP_LOOPBACK_MAX_PBUFS     0
+#endif
+
+#endif
@@ -1,68 +1,181 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
-#include "hardware/uart.h"
+#include "app.h"
+#include "hal.h"
+#include "udp_bridge.h"
+#include "uart_port.h"
+#if RX_ON_CORE1
+#include "pico/multicore.h"
+#include "rx_transform.h"
+#include "spsc_queue.h"
+#include "uart_rx.h"
+#endif
 
-const uint BTN_PIN = 22; // button GP22
-const uint UART1_TX_PIN = 8; // GPIO pin for UART1 TX
-const uint UART1_RX_PIN = 9; // GPIO pin for UART1 RX
+#ifndef RX_ON_CORE1
+#define RX_ON_CORE1 0 // 1: core1 drains and transforms UART RX
+#endif
+
+#ifndef BRIDGE_PEER_IP
+#define BRIDGE_PEER_IP "192.168.1.100" // UDP peer of the UART bridge
+#endif
+#ifndef BRIDGE_PORT
+#define BRIDGE_PORT 4210
+#endif
+
+static bool bridge_up;
+
+// Join the network given at build time and bridge UART1 to the UDP peer
+static void bridge_start(void) {
+#ifdef WIFI_SSID
+    cyw43_arch_enable_sta_mode();
+    if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 30000)) {
+        printf("Wi-Fi connect failed.\n");
+        return;
+    }
+
+    ip_addr_t peer;
+    if (!ipaddr_aton(BRIDGE_PEER_IP, &peer) || !udp_bridge_init(APP_UART, &peer, BRIDGE_PORT, BRIDGE_PORT)) {
+        printf("UDP bridge init failed.\n");
+        return;
+    }
+    app_set_rx_tap(udp_bridge_feed);
+    bridge_up = true;
+#endif
+}
+
+#if RX_ON_CORE1
+// Bytes taken from the RX ring per transform call
+#define RX_CHUNK 64
+
+// Core1 -> core0 results. Each chunk starts with a stamp entry: RX_STAMP,
+// port in bits 24-30 and the low 24 bits of its arrival time in us. Then
+// one entry per byte: received byte in bits 0-7, transformed byte in 8-15.
+#define RX_STAMP 0x80000000u
+#define RX_STAMP_TIME_MASK 0xFFFFFFu
+
+static uint32_t rx_result_storage[256];
+static spsc_queue_t rx_results;
+
+static void core1_entry(void) {
+    // Claim the UART IRQs here so they are serviced on core1
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        if (uart_ports[port].mode != UART_PORT_OFF) {
+            uart_rx_init(port);
+        }
+    }
+
+    uint8_t raw[RX_CHUNK], out[RX_CHUNK];
+    while (true) {
+        bool pushed = false;
+        bool more;
+        do {
+            // A chunk per port in turn while the queue has room
+            more = false;
+            for (uint32_t port = 0; port < UART_PORTS; port++) {
+                uint32_t space = spsc_queue_free(&rx_results);
+                if (uart_ports[port].mode == UART_PORT_OFF || space < 2) {
+                    continue;
+                }
+                space--; // the stamp
+                uint64_t arrival_us = uart_rx_arrival_us(port);
+                size_t n = uart_rx_read(port, raw, space < RX_CHUNK ? space : RX_CHUNK);
+                if (n == 0) {
+                    continue;
+                }
+                rx_transform_map(raw, out, n);
+                spsc_queue_push(&rx_results, RX_STAMP | (port << 24) |
+                                ((uint32_t)arrival_us & RX_STAMP_TIME_MASK));
+                for (size_t i = 0; i < n; i++) {
+                    spsc_queue_push(&rx_results, raw[i] | ((uint32_t)out[i] << 8));
+                }
+                pushed = true;
+                more = true;
+            }
+        } while (more);
+
+        // The FIFO only carries wakeups; if it is full core0 is already due to run
+        if (pushed) {
+            multicore_fifo_push_timeout_us(0, 0);
+        }
+        bool idle = true;
+        for (uint32_t port = 0; port < UART_PORTS; port++) {
+            if (uart_ports[port].mode != UART_PORT_OFF && uart_rx_available(port)) {
+                idle = false;
+            }
+        }
+        if (idle) {
+            __wfe(); // Sleep until the next UART IRQ
+        }
+    }
+}
+
+// Core0: hand what core1 produced to the app a chunk at a time
+static void rx_results_poll(void) {
+    static uint32_t port;
+    static uint64_t arrival_us;
+    uint8_t raw[RX_CHUNK], out[RX_CHUNK];
+    size_t n = 0;
+    uint32_t result;
+    while (spsc_queue_pop(&rx_results, &result)) {
+        if (result & RX_STAMP || n == RX_CHUNK) {
+            if (n) {
+                app_rx_results(port, raw, out, n, arrival_us);
+                n = 0;
+            }
+        }
+        if (result & RX_STAMP) {
+            // Widen the stamp against now, it is at most a few ms old
+            uint64_t now = hal_time_us();
+            port = (result >> 24) & 0x7F;
+            arrival_us = now - ((now - result) & RX_STAMP_TIME_MASK);
+            continue;
+        }
+        raw[n] = (uint8_t)result;
+        out[n] = (uint8_t)(result >> 8);
+        n++;
+    }
+    if (n) {
+        app_rx_results(port, raw, out, n, arrival_us);
+    }
+}
+#endif
 
 int main() {
     // Replace stdio_init_all with stdio_usb_init() if you experience random character outputs
     //stdio_init_all();
     stdio_usb_init();
 
-    //Set buttons
-    gpio_set_dir(BTN_PIN, GPIO_IN);vjhfv nfhgfjhv 
-    gpio_set_pulls(BTN_PIN, true, false);
-
-    //Set UART
-    uart_init(uart1, 9600); // Initialize UART1 with a baud rate of 9600
-    //uart_set_format(uart1, 8, 1, UART_PARITY_NONE);
-    gpio_set_function(UART1_TX_PIN, GPIO_FUNC_UART);
-    gpio_set_function(UART1_RX_PIN, GPIO_FUNC_UART);
+    //Set UARTs, pins and baud rates come from the port table in uart_port.c
+    uart_ports_init();
+#if RX_ON_CORE1
+    spsc_queue_init(&rx_results, rx_result_storage, 256);
+    multicore_launch_core1(core1_entry);
+#endif
 
     if (cyw43_arch_init()) {
         printf("Wi-Fi init failed.");
         return -1;
     }
 
-    char alphabet = 'A'; // Start at 'A'
+    app_init(!RX_ON_CORE1);
+    bridge_start();
 
     while (true) {
-        //Handle button press
-        if (gpio_get(BTN_PIN)) {
-            // Button is not pressed, send '1'
-            printf("Sent: 1\n");
-            uart_putc(uart1, '1');
-        } else {
-            // Button is pressed, send alphabet letters
-            printf("Sent: %c\n", alphabet);  // Transmit current letter
-            uart_putc(uart1, alphabet);
-            alphabet++;  // Move to the next letter
-
-            if (alphabet > 'Z') {
-                alphabet = 'A';  // Loop back to 'A' after 'Z'
-            }
+#if RX_ON_CORE1
+        // Clear wakeup tokens, then take whatever core1 has produced
+        while (multicore_fifo_rvalid()) {
+            multicore_fifo_pop_blocking();
         }
-        \
-        // Check for received data on UART1
-        if (uart_is_readable(uart1)) {
-            char received_char = uart_getc(uart1); // Read the received character
-
-            if (received_char >= 'A' && received_char <= 'Z') {
-                // Convert uppercase to lowercase
-                received_char += 32; // 'a' - 'A' = 32
-                printf("Received: %c\n", received_char);
-            } else if (received_char == '1') {
-                // Print '2' instead of '1'
-                printf("Received: 2\n");
-            }
+        rx_results_poll();
+#endif
+
+        bool busy = app_poll();
+        if (bridge_up) {
+            udp_bridge_poll();
         }
-        else{
-            printf("UART not readable\n");
+        if (!busy) {
+            hal_wait_for_event(); // Sleep until the next IRQ (button, timer or UART)
         }
-
-        sleep_ms(1000);  // 1-second delay between transmissions
     }
 }
@@ -0,0 +1,90 @@
+#ifndef RING_BUF_H
+#define RING_BUF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Byte ring with one producer and one consumer (e.g. an IRQ handler and the
+// main loop). Capacity must be a power of two so indices wrap with a mask.
+// head and tail run freely; head - tail is the fill level.
+typedef struct {
+    uint8_t *buf;
+    uint32_t mask;
+    volatile uint32_t head; // only written by the producer
+    volatile uint32_t tail; // only written by the consumer
+} ring_buf_t;
+
+static inline void ring_buf_init(ring_buf_t *rb, uint8_t *storage, uint32_t size) {
+    rb->buf = storage;
+    rb->mask = size - 1;
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+static inline uint32_t ring_buf_count(const ring_buf_t *rb) {
+    return rb->head - rb->tail;
+}
+
+static inline uint32_t ring_buf_free(const ring_buf_t *rb) {
+    return rb->mask + 1 - ring_buf_count(rb);
+}
+
+// Producer side. Returns false if the ring is full.
+static inline bool ring_buf_put(ring_buf_t *rb, uint8_t c) {
+    uint32_t head = rb->head;
+    if (head - rb->tail > rb->mask) {
+        return false;
+    }
+    rb->buf[head & rb->mask] = c;
+    __atomic_signal_fence(__ATOMIC_RELEASE); // publish data before head
+    rb->head = head + 1;
+    return true;
+}
+
+// Consumer side. Returns false if the ring is empty.
+static inline bool ring_buf_get(ring_buf_t *rb, uint8_t *c) {
+    uint32_t tail = rb->tail;
+    if (tail == rb->head) {
+        return false;
+    }
+    __atomic_signal_fence(__ATOMIC_ACQUIRE);
+    *c = rb->buf[tail & rb->mask];
+    rb->tail = tail + 1;
+    return true;
+}
+
+// Consumer side. Copies up to len bytes out, returns how many were copied.
+static inline size_t ring_buf_read(ring_buf_t *rb, uint8_t *dst, size_t len) {
+    uint32_t tail = rb->tail;
+    uint32_t avail = rb->head - tail;
+    if (len > avail) {
+        len = avail;
+    }
+    __atomic_signal_fence(__ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = rb->buf[(tail + i) & rb->mask];
+    }
+    rb->tail = tail + (uint32_t)len;
+    return len;
+}
+
+// Consumer side, without copying: points *data at the oldest bytes and
+// returns how many are contiguous there. They stay the consumer's, to read or
+// rewrite in place, until ring_buf_consume() gives them back.
+static inline size_t ring_buf_peek(ring_buf_t *rb, uint8_t **data) {
+    uint32_t tail = rb->tail;
+    uint32_t avail = rb->head - tail;
+    uint32_t start = tail & rb->mask;
+    uint32_t run = rb->mask + 1 - start; // stop at the wrap
+    __atomic_signal_fence(__ATOMIC_ACQUIRE);
+    *data = &rb->buf[start];
+    return avail < run ? avail : run;
+}
+
+static inline void ring_buf_consume(ring_buf_t *rb, size_t len) {
+    __atomic_signal_fence(__ATOMIC_RELEASE); // done with the bytes before the producer reuses them
+    rb->tail += (uint32_t)len;
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include <string.h>
+#include "rx_transform.h"
+
+#define RX_T(c) ((c) >= 'A' && (c) <= 'Z' ? (c) + 32 : (c) == '1' ? '2' : 0)
+#define RX_T4(c) RX_T(c), RX_T((c) + 1), RX_T((c) + 2), RX_T((c) + 3)
+#define RX_T16(c) RX_T4(c), RX_T4((c) + 4), RX_T4((c) + 8), RX_T4((c) + 12)
+#define RX_T64(c) RX_T16(c), RX_T16((c) + 16), RX_T16((c) + 32), RX_T16((c) + 48)
+
+const uint8_t rx_transform_lut[256] = {
+    RX_T64(0), RX_T64(64), RX_T64(128), RX_T64(192)
+};
+
+#define ONES  0x01010101u
+#define HIGHS 0x80808080u
+
+// Transform four bytes at once. Sets *keep to 0x80 in every lane whose byte
+// survives the transform.
+static inline uint32_t rx_transform_word(uint32_t x, uint32_t *keep) {
+    // Bytes with the top bit set are never kept, so work on 7-bit lanes
+    // where the additions below cannot carry into the next lane
+    uint32_t lo7 = x & ~HIGHS;
+    uint32_t ge_a = (lo7 + (0x80 - 'A') * ONES) & HIGHS;
+    uint32_t gt_z = (lo7 + (0x7F - 'Z') * ONES) & HIGHS;
+    uint32_t upper = ge_a & ~gt_z & ~x;
+
+    // Exact zero-byte test on x ^ '1'
+    uint32_t eq = x ^ ('1' * ONES);
+    uint32_t one = ~(((eq & ~HIGHS) + ~HIGHS) | eq) & HIGHS;
+
+    *keep = upper | one;
+    // +0x20 for uppercase lanes, +1 for '1' lanes, 0 everywhere else
+    return (x + (upper >> 2) + (one >> 7)) & ((*keep >> 7) * 0xFF);
+}
+
+void rx_transform_map(const uint8_t *in, uint8_t *out, size_t len) {
+    size_t i = 0;
+    // Byte at a time until the input is word aligned
+    for (; i < len && ((uintptr_t)(in + i) & 3); i++) {
+        out[i] = rx_transform_byte(in[i]);
+    }
+    for (; i + 4 <= len; i += 4) {
+        uint32_t x, keep;
+        memcpy(&x, __builtin_assume_aligned(in + i, 4), 4);
+        x = rx_transform_word(x, &keep);
+        memcpy(out + i, &x, 4);
+    }
+    for (; i < len; i++) {
+        out[i] = rx_transform_byte(in[i]);
+    }
+}
+
+size_t rx_transform(const uint8_t *in, uint8_t *out, size_t len) {
+    size_t i = 0;
+    size_t n = 0;
+    for (; i < len && ((uintptr_t)(in + i) & 3); i++) {
+        uint8_t c = rx_transform_byte(in[i]);
+        if (c) {
+            out[n++] = c;
+        }
+    }
+    for (; i + 4 <= len; i += 4) {
+        uint32_t x, keep;
+        memcpy(&x, __builtin_assume_aligned(in + i, 4), 4);
+        x = rx_transform_word(x, &keep);
+        if (keep == HIGHS) {
+            // Common case for text: all four kept, no compaction needed
+            memcpy(out + n, &x, 4);
+            n += 4;
+        } else if (keep) {
+            // Compact the kept lanes, byte 0 is the lowest lane
+            for (int b = 0; b < 4; b++, x >>= 8, keep >>= 8) {
+                if (keep & 0x80) {
+                    out[n++] = (uint8_t)x;
+                }
+            }
+        }
+    }
+    for (; i < len; i++) {
+        uint8_t c = rx_transform_byte(in[i]);
+        if (c) {
+            out[n++] = c;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,23 @@
+#ifndef RX_TRANSFORM_H
+#define RX_TRANSFORM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Receive transform: 'A'..'Z' become lowercase, '1' becomes '2' and every
+// other byte is dropped. A dropped byte maps to 0 in the table.
+extern const uint8_t rx_transform_lut[256];
+
+static inline uint8_t rx_transform_byte(uint8_t c) {
+    return rx_transform_lut[c];
+}
+
+// Transform len bytes from in to out, dropped bytes written as 0.
+// out may alias in.
+void rx_transform_map(const uint8_t *in, uint8_t *out, size_t len);
+
+// Transform len bytes from in to out, leaving dropped bytes out.
+// Returns the number of bytes written. out may alias in.
+size_t rx_transform(const uint8_t *in, uint8_t *out, size_t len);
+
+#endif
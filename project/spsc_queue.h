@@ -0,0 +1,81 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+// Lock-free single-producer/single-consumer queue of 32-bit entries.
+// Only needs C11 atomics, so it builds both for the RP2040 (producer and
+// consumer on different cores) and on a host with two threads.
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Keeps the producer and consumer indices on separate cache lines on hosts.
+// The RP2040 has no data cache, so there is nothing to gain from padding.
+#ifndef SPSC_CACHE_LINE
+#if defined(__ARM_ARCH_6M__)
+#define SPSC_CACHE_LINE 4
+#else
+#define SPSC_CACHE_LINE 64
+#endif
+#endif
+
+typedef struct {
+    // Producer side
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint32_t head;
+    uint32_t tail_cache; // producer's last view of tail
+
+    // Consumer side
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint32_t tail;
+    uint32_t head_cache; // consumer's last view of head
+
+    _Alignas(SPSC_CACHE_LINE) uint32_t *buf;
+    uint32_t mask;
+} spsc_queue_t;
+
+// size must be a power of two
+static inline void spsc_queue_init(spsc_queue_t *q, uint32_t *storage, uint32_t size) {
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->tail_cache = 0;
+    q->head_cache = 0;
+    q->buf = storage;
+    q->mask = size - 1;
+}
+
+// Producer only. Returns false if the queue is full.
+static inline bool spsc_queue_push(spsc_queue_t *q, uint32_t value) {
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head - q->tail_cache > q->mask) {
+        // Only go to the shared index when the cached one says full
+        q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+        if (head - q->tail_cache > q->mask) {
+            return false;
+        }
+    }
+    q->buf[head & q->mask] = value;
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Consumer only. Returns false if the queue is empty.
+static inline bool spsc_queue_pop(spsc_queue_t *q, uint32_t *value) {
+    uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail == q->head_cache) {
+        q->head_cache = atomic_load_explicit(&q->head, memory_order_acquire);
+        if (tail == q->head_cache) {
+            return false;
+        }
+    }
+    *value = q->buf[tail & q->mask];
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Producer only. Free slots, may under-report while the consumer is popping.
+static inline uint32_t spsc_queue_free(spsc_queue_t *q) {
+    uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    q->tail_cache = atomic_load_explicit(&q->tail, memory_order_acquire);
+    return q->mask + 1 - (head - q->tail_cache);
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include "stats.h"
+#include "hal.h"
+#include "log.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+
+#define STATS_CALIBRATE_RUNS 1024
+
+static stats_histogram_t stats_hist[STATS_HIST_COUNT];
+static volatile uint32_t stats_counter[STATS_COUNTER_COUNT];
+static uint32_t record_ns;
+
+static const char *const stats_hist_name[STATS_HIST_COUNT] = {
+    "btn_tx", "rx_proc", "log_drain",
+};
+
+static inline void stats_add(stats_histogram_t *h, uint32_t us) {
+    h->count++;
+    h->sum_us += us;
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+    h->buckets[stats_bucket(us)]++;
+}
+
+void stats_init(void) {
+    for (int i = 0; i < STATS_HIST_COUNT; i++) {
+        stats_hist[i] = (stats_histogram_t){0};
+    }
+    for (int i = 0; i < STATS_COUNTER_COUNT; i++) {
+        stats_counter[i] = 0;
+    }
+
+    // Time the recording path on a scratch histogram so the report can
+    // say what the instrumentation itself costs
+    static stats_histogram_t scratch;
+    uint64_t start = hal_time_us();
+    for (uint32_t i = 0; i < STATS_CALIBRATE_RUNS; i++) {
+        stats_add(&scratch, i);
+        __asm volatile("" ::: "memory"); // keep the loop from being folded
+    }
+    record_ns = (uint32_t)((hal_time_us() - start) * 1000 / STATS_CALIBRATE_RUNS);
+}
+
+void stats_record(stats_hist_t hist, uint32_t us) {
+    stats_add(&stats_hist[hist], us);
+}
+
+void stats_get(stats_hist_t hist, stats_histogram_t *out) {
+    uint32_t save = hal_irq_save();
+    *out = stats_hist[hist];
+    hal_irq_restore(save);
+}
+
+void stats_inc(stats_counter_t counter) {
+    stats_counter[counter]++;
+}
+
+uint32_t stats_record_ns(void) {
+    return record_ns;
+}
+
+size_t stats_format(char *buf, size_t len) {
+    size_t used = 0;
+#define STATS_PUT(...) \
+    do { \
+        if (used < len) { \
+            int n = snprintf(buf + used, len - used, __VA_ARGS__); \
+            used += n > 0 ? (size_t)n : 0; \
+        } \
+    } while (0)
+
+    for (uint32_t port = 0; port < UART_PORTS; port++) {
+        if (uart_ports[port].mode == UART_PORT_OFF) {
+            continue;
+        }
+        uart_rx_stats_t rx;
+        uart_rx_get_stats(port, &rx);
+        STATS_PUT("uart%lu tx=%lu txdrop=%lu rx=%lu rxovf=%lu fifoovr=%lu rxhw=%lu\n",
+                  (unsigned long)port, (unsigned long)uart_tx_bytes(port),
+                  (unsigned long)uart_tx_dropped(port), (unsigned long)rx.received,
+                  (unsigned long)rx.overflows, (unsigned long)rx.fifo_overruns,
+                  (unsigned long)rx.high_water);
+    }
+    STATS_PUT("rxidle=%lu logdrop=%lu rec_ns=%lu\n",
+              (unsigned long)stats_counter[STATS_RX_IDLE], (unsigned long)log_dropped(),
+              (unsigned long)record_ns);
+
+    for (int i = 0; i < STATS_HIST_COUNT; i++) {
+        stats_histogram_t h;
+        stats_get(i, &h);
+        STATS_PUT("%s n=%lu sum=%llu max=%lu b=", stats_hist_name[i], (unsigned long)h.count,
+                  (unsigned long long)h.sum_us, (unsigned long)h.max_us);
+        for (int b = 0; b < STATS_BUCKETS; b++) {
+            STATS_PUT(b ? ",%lu" : "%lu", (unsigned long)h.buckets[b]);
+        }
+        STATS_PUT("\n");
+    }
+    STATS_PUT("end\n");
+#undef STATS_PUT
+
+    // snprintf always leaves room for the terminator
+    return used < len ? used : len ? len - 1 : 0;
+}
@@ -0,0 +1,57 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Latency histograms with power-of-two buckets: bucket 0 holds 0 us and
+// bucket k holds [2^(k-1), 2^k) us; the last bucket is open ended.
+#define STATS_BUCKETS 20
+
+typedef enum {
+    STATS_BTN_TO_TX,       // button edge until the char is queued for TX
+    STATS_RX_TO_PROCESSED, // first byte into the RX ring until it is drained
+    STATS_LOG_DRAIN,       // time spent writing one log batch
+    STATS_HIST_COUNT
+} stats_hist_t;
+
+typedef enum {
+    STATS_RX_IDLE, // TX periods that passed with nothing received
+    STATS_COUNTER_COUNT
+} stats_counter_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[STATS_BUCKETS];
+} stats_histogram_t;
+
+// Clears the histograms and measures the cost of stats_record()
+void stats_init(void);
+
+static inline uint32_t stats_bucket(uint32_t us) {
+    if (us == 0) {
+        return 0;
+    }
+    uint32_t b = 32 - __builtin_clz(us);
+    return b < STATS_BUCKETS ? b : STATS_BUCKETS - 1;
+}
+
+// Constant time. Each histogram must only be recorded from one context
+// (one IRQ priority or the main loop).
+void stats_record(stats_hist_t hist, uint32_t us);
+
+void stats_get(stats_hist_t hist, stats_histogram_t *out);
+
+void stats_inc(stats_counter_t counter);
+
+// Mean cost of one stats_record() call, measured by stats_init()
+uint32_t stats_record_ns(void);
+
+// Write the counters and histograms as "key=value" lines, terminated by a
+// line holding only "end". Returns the length written, not counting the
+// terminator, so at most len - 1 when the output is truncated.
+size_t stats_format(char *buf, size_t len);
+
+#endif
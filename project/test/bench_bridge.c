@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+#include "lwip/udp.h"
+#include "test.h"
+#include "test_pty.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+#include "udp_bridge.h"
+
+// UART/UDP bridge throughput and latency over lwIP's loopback interface
+// (builds with LWIP_DIR only). A peer on UART1's PTY writes, the bridge
+// carries the bytes to an in-process UDP echo and back, and the peer reads
+// them again, so each figure covers UART RX, coalescing, two trips through
+// lwIP and UART TX.
+
+#define BENCH_PORT 1
+#define BENCH_UDP_PORT 4210
+#define BENCH_BYTES (1u << 20)
+#define BENCH_PROBES 200
+
+static int peer;
+
+static void echo_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                      const ip_addr_t *addr, u16_t port) {
+    udp_sendto(pcb, p, addr, port);
+    pbuf_free(p);
+}
+
+// One main loop pass, as in host_main.c
+static void pump(void) {
+    uint8_t *buf;
+    size_t n;
+    while ((n = uart_rx_peek(BENCH_PORT, &buf, SIZE_MAX)) > 0) {
+        udp_bridge_feed(BENCH_PORT, buf, n);
+        uart_rx_consume(BENCH_PORT, n);
+    }
+    udp_bridge_poll();
+    netif_poll_all(); // to the echo
+    netif_poll_all(); // and back
+    sys_check_timeouts();
+}
+
+// Read what the bridge sent back to the peer into buf, returns the count
+static size_t peer_read(uint8_t *buf, size_t len) {
+    ssize_t n = read(peer, buf, len);
+    return n > 0 ? n : 0;
+}
+
+static void bench_throughput(void) {
+    uint32_t written = 0, received = 0, bad = 0;
+    uint64_t start = test_now_ns();
+    uint64_t deadline = hal_time_us() + 30000000;
+    while (received < BENCH_BYTES && hal_time_us() < deadline) {
+        // Keep no more in flight than the return TX queue holds, or the
+        // bridge drops datagrams it has no room for
+        if (written < BENCH_BYTES && written - received + 256 <= UART_TX_BUF_SIZE) {
+            uint8_t chunk[256];
+            for (uint32_t i = 0; i < sizeof(chunk); i++) {
+                chunk[i] = test_pattern(0, written + i);
+            }
+            ssize_t n = write(peer, chunk, sizeof(chunk));
+            written += n > 0 ? n : 0;
+        }
+        pump();
+        uint8_t buf[4096];
+        size_t n = peer_read(buf, sizeof(buf));
+        for (size_t i = 0; i < n; i++) {
+            bad += buf[i] != test_pattern(0, received++);
+        }
+        if (n == 0) {
+            hal_wait_for_event();
+        }
+    }
+    uint64_t ns = test_now_ns() - start;
+    printf("bench_bridge: round trip %u/%u bytes %.2f MB/s, mismatched %u\n", received,
+           BENCH_BYTES, received * 1e3 / ns, bad);
+    CHECK_EQ(received, BENCH_BYTES);
+    CHECK_EQ(bad, 0);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Round trip of a probe of len bytes sent on an idle link: a short one waits
+// for the flush timer, a full datagram goes out as soon as it is complete
+static void bench_latency(size_t len) {
+    uint32_t us[BENCH_PROBES];
+    int done = 0;
+    for (int p = 0; p < BENCH_PROBES; p++) {
+        uint8_t probe[UDP_BRIDGE_MAX_DATAGRAM];
+        for (size_t i = 0; i < len; i++) {
+            probe[i] = test_pattern(p, i);
+        }
+        uint64_t start = hal_time_us();
+        if (write(peer, probe, len) != (ssize_t)len) {
+            continue;
+        }
+        size_t got = 0;
+        while (got < len && hal_time_us() - start < 1000000) {
+            pump();
+            uint8_t buf[UDP_BRIDGE_MAX_DATAGRAM];
+            size_t n = peer_read(buf, len - got);
+            got += n;
+            if (n == 0) {
+                hal_wait_for_event();
+            }
+        }
+        if (got == len) {
+            us[done++] = (uint32_t)(hal_time_us() - start);
+        }
+    }
+    CHECK_EQ(done, BENCH_PROBES);
+    if (done == 0) {
+        return;
+    }
+    qsort(us, done, sizeof(us[0]), cmp_u32);
+    printf("bench_bridge: %3zu-byte probe round trip us: p50 %u p90 %u p99 %u max %u (n=%d)\n",
+           len, us[done / 2], us[done * 9 / 10], us[done * 99 / 100], us[done - 1], done);
+}
+
+int main(void) {
+    uart_ports[0].mode = UART_PORT_OFF;
+    uart_ports_init();
+    uart_rx_init(BENCH_PORT);
+    test_tick_start(1000);
+
+    lwip_init(); // brings up the 127.0.0.1 loopback interface
+    struct udp_pcb *echo = udp_new();
+    ip_addr_t loopback;
+    ip_addr_set_loopback(false, &loopback);
+    if (!echo || udp_bind(echo, IP_ADDR_ANY, BENCH_UDP_PORT + 1) != ERR_OK ||
+        !udp_bridge_init(BENCH_PORT, &loopback, BENCH_UDP_PORT + 1, BENCH_UDP_PORT)) {
+        fprintf(stderr, "bench_bridge: lwIP setup failed\n");
+        return 1;
+    }
+    udp_recv(echo, echo_recv, NULL);
+
+    peer = test_pty_open(BENCH_PORT);
+    if (peer < 0) {
+        return 1;
+    }
+
+    bench_latency(1);
+    bench_latency(UDP_BRIDGE_MAX_DATAGRAM);
+    bench_throughput();
+
+    udp_bridge_stats_t s;
+    udp_bridge_get_stats(&s);
+    printf("bench_bridge: tx %u datagrams %u bytes %u dropped %u late, "
+           "rx %u datagrams %u bytes %u dropped\n",
+           s.tx_datagrams, s.tx_bytes, s.tx_dropped, s.tx_late,
+           s.rx_datagrams, s.rx_bytes, s.rx_dropped);
+    CHECK_EQ(s.tx_dropped, 0);
+    CHECK_EQ(s.rx_dropped, 0);
+    close(peer);
+    return test_result(); // nonzero if the bridge lost or garbled anything
+}
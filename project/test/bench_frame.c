@@ -0,0 +1,63 @@
+#include <string.h>
+#include "frame.h"
+#include "test.h"
+
+// Encoder -> decoder loopback throughput at a few batch sizes. One-byte
+// events are batched like send_next() does, and the wire is fed to the
+// decoder in 64-byte chunks like app_poll() does.
+
+#define BENCH_EVENTS 4000000
+#define BENCH_RX_CHUNK 64
+
+static uint32_t delivered;
+
+static void on_frame(uint8_t seq, const uint8_t *payload, size_t len, void *ctx) {
+    delivered += len;
+}
+
+static void bench(size_t max_payload) {
+    frame_encoder_t enc;
+    frame_decoder_t dec;
+    frame_encoder_init(&enc, max_payload);
+    frame_decoder_init(&dec, on_frame, NULL);
+    delivered = 0;
+
+    static uint8_t wire[BENCH_RX_CHUNK * 64];
+    size_t wire_len = 0;
+    uint64_t wire_total = 0;
+    uint64_t start = test_now_ns();
+    for (uint32_t i = 0; i < BENCH_EVENTS; i++) {
+        uint8_t c = 'A' + i % 26;
+        if (!frame_encoder_add(&enc, &c, 1)) {
+            if (wire_len + FRAME_MAX_ENCODED > sizeof(wire)) {
+                for (size_t o = 0; o < wire_len; o += BENCH_RX_CHUNK) {
+                    size_t n = wire_len - o < BENCH_RX_CHUNK ? wire_len - o : BENCH_RX_CHUNK;
+                    frame_decoder_push(&dec, wire + o, n);
+                }
+                wire_total += wire_len;
+                wire_len = 0;
+            }
+            wire_len += frame_encoder_flush(&enc, wire + wire_len);
+            frame_encoder_add(&enc, &c, 1);
+        }
+    }
+    wire_len += frame_encoder_flush(&enc, wire + wire_len);
+    frame_decoder_push(&dec, wire, wire_len);
+    wire_total += wire_len;
+    uint64_t ns = test_now_ns() - start;
+
+    printf("bench_frame: payload %3zu  %6.1f MB/s of events, wire %.2fx, frames %u, errors %u\n",
+           max_payload, delivered * 1e3 / ns, (double)wire_total / delivered, dec.frames,
+           dec.crc_errors + dec.bad_frames + dec.lost_frames);
+    if (delivered != BENCH_EVENTS) {
+        printf("bench_frame: delivered %u of %u events\n", delivered, BENCH_EVENTS);
+    }
+}
+
+int main(void) {
+    const size_t sizes[] = {1, 16, 64, FRAME_MAX_PAYLOAD};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench(sizes[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include "hal.h"
+#include "log.h"
+#include "stats.h"
+#include "test.h"
+
+// Per-event cost on the hot path: formatting and writing each line as it
+// happens (the old printf path) against queueing a binary record with
+// log_event(). The log output goes to /dev/null, so "before" is a lower
+// bound; on the Pico a USB CDC host that isn't reading makes it block.
+
+#define BENCH_EVENTS 1000000
+#define BENCH_BATCH 128 // records queued between drains, under LOG_RING_SIZE
+
+int main(void) {
+    if (!freopen("/dev/null", "w", stdout)) {
+        return 1;
+    }
+    stats_init();
+    log_init();
+
+    uint64_t start = test_now_ns();
+    for (int i = 0; i < BENCH_EVENTS; i++) {
+        char line[32];
+        int n = snprintf(line, sizeof(line), "Sent: %c\n", 'A' + i % 26);
+        hal_log_write(line, n);
+    }
+    uint64_t before_ns = test_now_ns() - start;
+
+    uint64_t after_ns = 0;
+    for (int i = 0; i < BENCH_EVENTS; i += BENCH_BATCH) {
+        start = test_now_ns();
+        for (int j = 0; j < BENCH_BATCH; j++) {
+            log_event(LOG_EVT_SENT, 1, 'A' + (i + j) % 26);
+        }
+        after_ns += test_now_ns() - start;
+        while (log_drain()) {
+        }
+    }
+
+    fprintf(stderr, "bench_log: printf path %.1f ns/event, log_event %.1f ns/event, dropped %u\n",
+            (double)before_ns / BENCH_EVENTS, (double)after_ns / BENCH_EVENTS, log_dropped());
+    return 0;
+}
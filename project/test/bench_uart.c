@@ -0,0 +1,85 @@
+#include <unistd.h>
+#include "test.h"
+#include "test_pty.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+
+// Host throughput of the UART engine over a PTY: the TX queue drained into
+// the PTY while a peer reads it, then the peer flooding the RX ring while the
+// main loop reads it. Every byte is checked on the far side, so a byte the
+// HAL loses shows up as a mismatch rather than as extra throughput.
+
+#define BENCH_PORT 1
+#define BENCH_BYTES (4u << 20)
+#define BENCH_CHUNK 256
+
+static void bench_tx(int peer) {
+    uint32_t queued = 0, received = 0, bad = 0;
+    uint64_t start = test_now_ns();
+    while (received < BENCH_BYTES) {
+        while (queued < BENCH_BYTES && uart_tx_free(BENCH_PORT) >= BENCH_CHUNK) {
+            uint8_t chunk[BENCH_CHUNK];
+            for (uint32_t i = 0; i < BENCH_CHUNK; i++) {
+                chunk[i] = test_pattern(0, queued + i);
+            }
+            uart_tx_write(BENCH_PORT, chunk, BENCH_CHUNK);
+            queued += BENCH_CHUNK;
+        }
+        uint8_t buf[4096];
+        ssize_t n = read(peer, buf, sizeof(buf));
+        for (ssize_t i = 0; i < n; i++) {
+            bad += buf[i] != test_pattern(0, received++);
+        }
+        if (n <= 0) {
+            hal_wait_for_event();
+        }
+    }
+    uint64_t ns = test_now_ns() - start;
+    printf("bench_uart: tx %u bytes %.1f MB/s, tx_bytes %u dropped %u mismatched %u\n",
+           received, received * 1e3 / ns, uart_tx_bytes(BENCH_PORT),
+           uart_tx_dropped(BENCH_PORT), bad);
+}
+
+static void bench_rx(int peer) {
+    uint32_t written = 0, received = 0, bad = 0;
+    uint64_t start = test_now_ns();
+    while (received < BENCH_BYTES) {
+        if (written < BENCH_BYTES) {
+            uint8_t chunk[BENCH_CHUNK];
+            for (uint32_t i = 0; i < BENCH_CHUNK; i++) {
+                chunk[i] = test_pattern(0, written + i);
+            }
+            ssize_t n = write(peer, chunk, BENCH_CHUNK);
+            written += n > 0 ? n : 0;
+        }
+        hal_wait_for_event();
+        uint8_t buf[BENCH_CHUNK];
+        size_t n;
+        while ((n = uart_rx_read(BENCH_PORT, buf, sizeof(buf))) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                bad += buf[i] != test_pattern(0, received++);
+            }
+        }
+    }
+    uint64_t ns = test_now_ns() - start;
+    uart_rx_stats_t s;
+    uart_rx_get_stats(BENCH_PORT, &s);
+    printf("bench_uart: rx %u bytes %.1f MB/s, overflows %u high water %u mismatched %u\n",
+           received, received * 1e3 / ns, s.overflows, s.high_water, bad);
+}
+
+int main(void) {
+    uart_ports[0].mode = UART_PORT_OFF;
+    uart_ports_init();
+    uart_rx_init(BENCH_PORT);
+    test_tick_start(1000);
+
+    int peer = test_pty_open(BENCH_PORT);
+    if (peer < 0) {
+        return 1;
+    }
+    bench_tx(peer);
+    bench_rx(peer);
+    close(peer);
+    return 0;
+}
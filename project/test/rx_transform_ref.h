@@ -0,0 +1,19 @@
+#ifndef RX_TRANSFORM_REF_H
+#define RX_TRANSFORM_REF_H
+
+#include <stdint.h>
+
+// The original per-char rules from main.c, the reference the kernels are
+// checked and measured against. Returns 0 for a dropped byte.
+static inline uint8_t rx_transform_ref(uint8_t c) {
+    if (c >= 'A' && c <= 'Z') {
+        c += 32; // Convert to lowercase
+    } else if (c == '1') {
+        c = '2'; // Convert '1' to '2'
+    } else {
+        c = 0; // Drop anything else
+    }
+    return c;
+}
+
+#endif
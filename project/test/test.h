@@ -0,0 +1,44 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Minimal helpers shared by the host tests and benchmarks. A test keeps
+// going after a failed CHECK and returns test_result() from main().
+
+static int test_failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        unsigned long long a_ = (a), b_ = (b); \
+        if (a_ != b_) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %llu != %llu\n", \
+                    __FILE__, __LINE__, #a, #b, a_, b_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+static inline int test_result(void) {
+    if (test_failures) {
+        fprintf(stderr, "%d check(s) failed\n", test_failures);
+    }
+    return test_failures ? 1 : 0;
+}
+
+static inline uint64_t test_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include "button.h"
+#include "hal.h"
+#include "hal_host.h"
+#include "test.h"
+#include "test_pty.h"
+
+// Drives scripted edge sequences through the host's simulated button pin and
+// reports the edge-to-press latency distribution. Each cycle has a clean
+// press with contact bounce, and a press that lands inside a debounce window
+// and is only picked up by the re-check.
+
+#define TEST_PIN 22
+#define TEST_DEBOUNCE_US 20000
+#define TEST_START_US 100000
+#define TEST_CYCLE_US 150000
+#define TEST_CYCLES 20
+
+typedef struct {
+    uint64_t now_us;
+    uint64_t edge_us;
+} press_t;
+
+static press_t presses[2 * TEST_CYCLES + 8];
+static int press_count;
+
+static void on_press(void) {
+    if (press_count < (int)(sizeof(presses) / sizeof(presses[0]))) {
+        presses[press_count].now_us = hal_time_us();
+        presses[press_count].edge_us = button_edge_us();
+    }
+    press_count++;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Edges sit at least 15ms from the windows around them: host wakeups run a
+// few ms late, and each re-armed alarm carries the lateness forward
+static bool write_script(char *path) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return false;
+    }
+    FILE *f = fdopen(fd, "w");
+    fprintf(f, "# time_us level, 0 = pressed\n");
+    for (int j = 0; j < TEST_CYCLES; j++) {
+        uint64_t c = TEST_START_US + (uint64_t)j * TEST_CYCLE_US;
+        fprintf(f, "%llu 0\n", (unsigned long long)c);          // clean press
+        fprintf(f, "%llu 1\n", (unsigned long long)c + 300);    // bounce
+        fprintf(f, "%llu 0\n", (unsigned long long)c + 600);
+        fprintf(f, "%llu 1\n", (unsigned long long)c + 40000);  // release, opens a window
+        fprintf(f, "%llu 0\n", (unsigned long long)c + 45000);  // press inside it
+        fprintf(f, "%llu 1\n", (unsigned long long)c + 75000);  // release inside the re-check's window
+    }
+    fclose(f);
+    return true;
+}
+
+int main(void) {
+    char path[] = "/tmp/test_button_XXXXXX";
+    hal_time_us(); // script times count from here
+    CHECK(write_script(path));
+    CHECK(hal_host_load_button_script(path));
+    unlink(path);
+
+    button_init(TEST_PIN, TEST_DEBOUNCE_US, on_press);
+    test_tick_start(10000); // or the last wait sleeps past the end of the run
+    uint64_t end_us = TEST_START_US + (uint64_t)TEST_CYCLES * TEST_CYCLE_US;
+    while (hal_time_us() < end_us) {
+        hal_wait_for_event();
+    }
+
+    CHECK_EQ(press_count, 2 * TEST_CYCLES);
+    if (press_count != 2 * TEST_CYCLES) {
+        return test_result();
+    }
+
+    uint32_t clean[TEST_CYCLES];
+    uint32_t stale_max = 0;
+    for (int j = 0; j < TEST_CYCLES; j++) {
+        uint64_t c = TEST_START_US + (uint64_t)j * TEST_CYCLE_US;
+        clean[j] = (uint32_t)(presses[2 * j].now_us - c);
+
+        // The re-check fires when the window opened by the release closes
+        const press_t *p = &presses[2 * j + 1];
+        CHECK(p->now_us >= c + 40000 + TEST_DEBOUNCE_US);
+
+        // Both paths stamp the edge when they act on it
+        for (int k = 0; k < 2; k++) {
+            uint32_t age = (uint32_t)(presses[2 * j + k].now_us - presses[2 * j + k].edge_us);
+            if (age > stale_max) {
+                stale_max = age;
+            }
+        }
+    }
+    qsort(clean, TEST_CYCLES, sizeof(clean[0]), cmp_u32);
+    printf("edge->press us: min %u p50 %u p90 %u max %u (n=%d), edge stamp age max %u\n",
+           clean[0], clean[TEST_CYCLES / 2], clean[TEST_CYCLES * 9 / 10], clean[TEST_CYCLES - 1],
+           TEST_CYCLES, stale_max);
+
+    // Sub-millisecond target; the host adds scheduler wakeup jitter on top
+    CHECK(clean[TEST_CYCLES / 2] < 1000);
+    CHECK(stale_max < TEST_DEBOUNCE_US / 2);
+    return test_result();
+}
@@ -0,0 +1,194 @@
+#include <stdlib.h>
+#include <string.h>
+#include "frame.h"
+#include "test.h"
+
+// Encoder/decoder round trips at every payload size, plus the decoder's
+// rejection paths: corrupted CRC, sequence gaps and resyncs, overlong input,
+// and a frame with a valid CRC whose payload is bigger than FRAME_MAX_PAYLOAD.
+
+typedef struct {
+    uint8_t payload[FRAME_MAX_ENCODED];
+    size_t len;
+    uint8_t seq;
+    int count;
+} rx_t;
+
+static void on_frame(uint8_t seq, const uint8_t *payload, size_t len, void *ctx) {
+    rx_t *rx = ctx;
+    rx->len = len;
+    rx->seq = seq;
+    rx->count++;
+    if (len <= sizeof(rx->payload)) {
+        memcpy(rx->payload, payload, len);
+    }
+}
+
+// Plain COBS, so the test can build frames the encoder never would
+static size_t cobs(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t code_pos = 0, o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+        if (in[i]) {
+            out[o++] = in[i];
+            code++;
+        }
+        if (!in[i] || code == 0xFF) {
+            out[code_pos] = code;
+            code_pos = o++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return o;
+}
+
+static void test_round_trip(void) {
+    frame_encoder_t enc;
+    frame_decoder_t dec;
+    rx_t rx = {0};
+    frame_encoder_init(&enc, FRAME_MAX_PAYLOAD);
+    frame_decoder_init(&dec, on_frame, &rx);
+
+    srand(1);
+    for (size_t len = 1; len <= FRAME_MAX_PAYLOAD; len++) {
+        uint8_t payload[FRAME_MAX_PAYLOAD];
+        for (size_t i = 0; i < len; i++) {
+            payload[i] = rand() % 4 ? (uint8_t)rand() : 0; // plenty of zeros
+        }
+        CHECK(frame_encoder_add(&enc, payload, len));
+        uint8_t wire[FRAME_MAX_ENCODED];
+        size_t n = frame_encoder_flush(&enc, wire);
+        CHECK(n <= FRAME_MAX_ENCODED && wire[n - 1] == 0);
+        CHECK(memchr(wire, 0, n - 1) == NULL);
+
+        frame_decoder_push(&dec, wire, n);
+        CHECK(rx.len == len && memcmp(rx.payload, payload, len) == 0);
+        CHECK_EQ(rx.seq, (uint8_t)(len - 1));
+    }
+    CHECK_EQ(rx.count, FRAME_MAX_PAYLOAD);
+    CHECK_EQ(dec.frames, FRAME_MAX_PAYLOAD);
+    CHECK_EQ(dec.crc_errors + dec.bad_frames + dec.lost_frames, 0);
+
+    // Full encoder: add refuses rather than overrunning
+    uint8_t byte = 'A';
+    frame_encoder_set_max(&enc, 4);
+    for (int i = 0; i < 4; i++) {
+        CHECK(frame_encoder_add(&enc, &byte, 1));
+    }
+    CHECK(!frame_encoder_add(&enc, &byte, 1));
+    CHECK_EQ(frame_encoder_pending(&enc), 4);
+}
+
+// Backward jumps in seq resync without counting lost frames
+static void test_resync(void) {
+    frame_encoder_t enc;
+    frame_decoder_t dec;
+    rx_t rx = {0};
+    frame_encoder_init(&enc, FRAME_MAX_PAYLOAD);
+    frame_decoder_init(&dec, on_frame, &rx);
+
+    uint8_t wire[FRAME_MAX_ENCODED];
+    uint8_t event = 'A';
+    size_t n = 0;
+    for (int i = 0; i < 4; i++) {
+        frame_encoder_add(&enc, &event, 1);
+        n = frame_encoder_flush(&enc, wire);
+        frame_decoder_push(&dec, wire, n);
+    }
+
+    // A duplicate of seq 3, then seq 4
+    frame_decoder_push(&dec, wire, n);
+    frame_encoder_add(&enc, &event, 1);
+    n = frame_encoder_flush(&enc, wire);
+    frame_decoder_push(&dec, wire, n);
+    CHECK_EQ(dec.frames, 6);
+    CHECK_EQ(dec.lost_frames, 0);
+    CHECK_EQ(dec.resyncs, 1);
+
+    // The peer restarts from seq 0
+    frame_encoder_init(&enc, FRAME_MAX_PAYLOAD);
+    for (int i = 0; i < 2; i++) {
+        frame_encoder_add(&enc, &event, 1);
+        n = frame_encoder_flush(&enc, wire);
+        frame_decoder_push(&dec, wire, n);
+    }
+    CHECK_EQ(rx.seq, 1);
+    CHECK_EQ(dec.lost_frames, 0);
+    CHECK_EQ(dec.resyncs, 2);
+
+    // 127 frames skipped is still a forward gap
+    for (int i = 0; i < 128; i++) {
+        frame_encoder_add(&enc, &event, 1);
+        n = frame_encoder_flush(&enc, wire);
+    }
+    frame_decoder_push(&dec, wire, n);
+    CHECK_EQ(dec.lost_frames, 127);
+    CHECK_EQ(dec.resyncs, 2);
+}
+
+static void test_rejects(void) {
+    frame_encoder_t enc;
+    frame_decoder_t dec;
+    rx_t rx = {0};
+    frame_encoder_init(&enc, FRAME_MAX_PAYLOAD);
+    frame_decoder_init(&dec, on_frame, &rx);
+
+    uint8_t wire[FRAME_MAX_ENCODED];
+    uint8_t event = 'A';
+    frame_encoder_add(&enc, &event, 1);
+    size_t n = frame_encoder_flush(&enc, wire);
+    *(uint8_t *)memchr(wire, 'A', n) ^= 0x20; // corrupt the payload
+    frame_decoder_push(&dec, wire, n);
+    CHECK_EQ(dec.crc_errors, 1);
+
+    // seq 1 is good, seq 2 skipped, seq 3 counts one lost frame
+    for (int i = 0; i < 3; i++) {
+        frame_encoder_add(&enc, &event, 1);
+        n = frame_encoder_flush(&enc, wire);
+        if (i != 1) {
+            frame_decoder_push(&dec, wire, n);
+        }
+    }
+    CHECK_EQ(dec.frames, 2);
+    CHECK_EQ(dec.lost_frames, 1);
+
+
+    // No delimiter for longer than any valid frame
+    uint8_t junk[FRAME_MAX_ENCODED + 8];
+    memset(junk, 'x', sizeof(junk));
+    frame_decoder_push(&dec, junk, sizeof(junk));
+    frame_decoder_push(&dec, (const uint8_t *)"", 1);
+    CHECK_EQ(dec.bad_frames, 1);
+
+    // Valid COBS and CRC, but one byte more payload than any caller expects
+    uint8_t raw[FRAME_MAX_RAW + 1];
+    raw[0] = 4;
+    memset(raw + 1, 'A', FRAME_MAX_PAYLOAD + 1);
+    raw[100] = 0; // a zero costs no COBS overhead, so this encodes to 256 bytes
+    uint16_t crc = frame_crc16(0xFFFF, raw, FRAME_MAX_PAYLOAD + 2);
+    raw[FRAME_MAX_PAYLOAD + 2] = crc & 0xFF;
+    raw[FRAME_MAX_PAYLOAD + 3] = crc >> 8;
+    uint8_t big[FRAME_MAX_ENCODED + 8];
+    n = cobs(raw, sizeof(raw), big);
+    big[n++] = 0;
+    CHECK(n - 1 <= sizeof(dec.buf)); // fits the buffer, so only the length check stops it
+    int before = rx.count;
+    frame_decoder_push(&dec, big, n);
+    CHECK_EQ(rx.count, before);
+    CHECK_EQ(dec.bad_frames, 2);
+    CHECK_EQ(dec.frames, 2);
+
+    // And the decoder is still in step afterwards
+    frame_encoder_add(&enc, &event, 1);
+    n = frame_encoder_flush(&enc, wire);
+    frame_decoder_push(&dec, wire, n);
+    CHECK_EQ(dec.frames, 3);
+}
+
+int main(void) {
+    test_round_trip();
+    test_rejects();
+    test_resync();
+    return test_result();
+}
@@ -0,0 +1,139 @@
+#include <stdint.h>
+#include <string.h>
+#include "hal.h"
+#include "log.h"
+#include "stats.h"
+#include "test.h"
+
+// log_drain() against a scripted output: how much room the host has left and
+// a Pico-style "\r\n" for every '\n'. Checks only whole lines are written,
+// every batch fits the room as sent, and a room smaller than one line reports
+// the output blocked rather than more work to do.
+
+// Stand-in HAL and stats, just what log.c uses
+static uint64_t fake_now_us;
+static size_t fake_space;
+static char written[4096];
+static size_t written_len;
+static size_t written_sent; // as the output sends it, "\r\n" for '\n'
+static int writes;
+
+uint64_t hal_time_us(void) {
+    return fake_now_us;
+}
+
+uint32_t hal_irq_save(void) {
+    return 0;
+}
+
+void hal_irq_restore(uint32_t state) {
+}
+
+size_t hal_log_space(void) {
+    return fake_space;
+}
+
+size_t hal_log_eol_len(void) {
+    return 2;
+}
+
+void hal_log_write(const char *buf, size_t len) {
+    writes++;
+    for (size_t i = 0; i < len; i++) {
+        written_sent += buf[i] == '\n' ? 2 : 1;
+    }
+    if (written_len + len <= sizeof(written)) {
+        memcpy(written + written_len, buf, len);
+        written_len += len;
+    }
+}
+
+void stats_record(stats_hist_t hist, uint32_t us) {
+}
+
+static void reset_output(size_t space) {
+    fake_space = space;
+    written_len = 0;
+    written_sent = 0;
+    writes = 0;
+}
+
+static size_t count_lines(void) {
+    size_t lines = 0;
+    for (size_t i = 0; i < written_len; i++) {
+        lines += written[i] == '\n';
+    }
+    return lines;
+}
+
+// The line each test record formats to, and its length with "\r\n"
+#define LINE "[0.000001] uart1 Received: A\n"
+#define LINE_SENT (sizeof(LINE) - 1 + 1)
+
+static void test_batches_fit_as_sent(void) {
+    log_init();
+    fake_now_us = 1;
+    for (int i = 0; i < LOG_DRAIN_BATCH; i++) {
+        log_event(LOG_EVT_RECEIVED, 1, 'A');
+    }
+
+    // Exactly a full batch with the "\r\n"s, then one byte short of it
+    reset_output(LOG_DRAIN_BATCH * LINE_SENT);
+    CHECK(!log_drain());
+    CHECK_EQ(count_lines(), LOG_DRAIN_BATCH);
+    CHECK_EQ(written_sent, LOG_DRAIN_BATCH * LINE_SENT);
+
+    for (int i = 0; i < LOG_DRAIN_BATCH; i++) {
+        log_event(LOG_EVT_RECEIVED, 1, 'A');
+    }
+    reset_output(LOG_DRAIN_BATCH * LINE_SENT - 1);
+    CHECK(log_drain()); // one line left over, and there may be room later
+    CHECK_EQ(count_lines(), LOG_DRAIN_BATCH - 1);
+    CHECK(written_sent <= fake_space);
+    reset_output(LINE_SENT);
+    CHECK(!log_drain());
+    CHECK_EQ(count_lines(), 1);
+}
+
+static void test_blocked_output(void) {
+    log_init();
+    log_event(LOG_EVT_RECEIVED, 1, 'A');
+
+    // Room, but less than a line: nothing written and nothing to spin on
+    for (size_t space = 0; space < LINE_SENT; space++) {
+        reset_output(space);
+        CHECK(!log_drain());
+        CHECK_EQ(writes, 0);
+    }
+    reset_output(LINE_SENT);
+    CHECK(!log_drain());
+    CHECK_EQ(writes, 1);
+    CHECK(written_len == sizeof(LINE) - 1 && memcmp(written, LINE, written_len) == 0);
+}
+
+static void test_drop_report(void) {
+    log_init();
+    for (int i = 0; i < LOG_RING_SIZE + 5; i++) {
+        log_event(LOG_EVT_RECEIVED, 1, 'A');
+    }
+    CHECK_EQ(log_dropped(), 5);
+
+    // "Log dropped: 5\n" is 16 bytes as sent; with less the report waits too
+    reset_output(15);
+    CHECK(!log_drain());
+    CHECK_EQ(writes, 0);
+    reset_output(16);
+    CHECK(log_drain()); // the report alone, records still queued behind it
+    CHECK(written_len == 15 && memcmp(written, "Log dropped: 5\n", 15) == 0);
+    reset_output(16 + LINE_SENT);
+    CHECK(log_drain());
+    CHECK_EQ(count_lines(), 1); // reported once, then a record
+    CHECK(memcmp(written, "[", 1) == 0);
+}
+
+int main(void) {
+    test_batches_fit_as_sent();
+    test_blocked_output();
+    test_drop_report();
+    return test_result();
+}
@@ -0,0 +1,112 @@
+#include <stdbool.h>
+#include <unistd.h>
+#include "test.h"
+#include "test_pty.h"
+#include "uart_rx.h"
+
+// Floods both PTYs at once and drains both rings from one main loop, as the
+// firmware does. Checks every byte arrives in order on its own port, nothing
+// overflows, and the dispatcher's round robin keeps the ports level: one wait
+// with both ports backed up serves both alike, and when the first port
+// finishes the other must be nearly done too.
+
+#define TEST_BYTES (512 * 1024) // per port
+#define TEST_TICK_US 200
+#define TEST_TIMEOUT_US 20000000
+#define TEST_PRELOAD 1024 // per port, more than one wait delivers
+#define TEST_MIN_SHARE 90 // percent of the stream the slower port must have when the faster finishes
+
+int main(void) {
+    uart_ports_init();
+    int peer[UART_PORTS];
+    for (uint32_t p = 0; p < UART_PORTS; p++) {
+        uart_rx_init(p);
+        peer[p] = test_pty_open(p);
+        CHECK(peer[p] >= 0);
+        if (peer[p] < 0) {
+            return test_result();
+        }
+    }
+    test_tick_start(TEST_TICK_US);
+
+    uint32_t sent[UART_PORTS] = {0};
+    uint32_t checked[UART_PORTS] = {0};
+    uint32_t at_first_done[UART_PORTS] = {0};
+    bool first_done = false;
+    bool in_order[UART_PORTS] = {true, true};
+
+    // Back both ports up, then give the dispatcher a single wait
+    for (uint32_t p = 0; p < UART_PORTS; p++) {
+        uint8_t chunk[TEST_PRELOAD];
+        for (uint32_t i = 0; i < sizeof(chunk); i++) {
+            chunk[i] = test_pattern(p, i);
+        }
+        CHECK_EQ(write(peer[p], chunk, sizeof(chunk)), sizeof(chunk));
+        sent[p] = sizeof(chunk);
+    }
+    usleep(10000); // let the PTYs pass it to the masters
+    hal_wait_for_event();
+    uart_rx_stats_t one[UART_PORTS];
+    for (uint32_t p = 0; p < UART_PORTS; p++) {
+        uart_rx_get_stats(p, &one[p]);
+    }
+    CHECK(one[0].received > 0 && one[0].received < TEST_PRELOAD);
+    CHECK_EQ(one[1].received, one[0].received);
+    printf("one wait with both ports backed up: %u + %u bytes\n", one[0].received, one[1].received);
+
+    uint64_t start = hal_time_us();
+    uint64_t deadline = start + TEST_TIMEOUT_US;
+    while ((checked[0] < TEST_BYTES || checked[1] < TEST_BYTES) && hal_time_us() < deadline) {
+        // Peers: keep both PTYs as full as they will go
+        for (uint32_t p = 0; p < UART_PORTS; p++) {
+            uint8_t chunk[256];
+            uint32_t n = 0;
+            while (sent[p] + n < TEST_BYTES && n < sizeof(chunk)) {
+                chunk[n] = test_pattern(p, sent[p] + n);
+                n++;
+            }
+            ssize_t w = n ? write(peer[p], chunk, n) : 0;
+            if (w > 0) {
+                sent[p] += w;
+            }
+        }
+
+        hal_wait_for_event();
+
+        // Main loop: drain both rings
+        for (uint32_t p = 0; p < UART_PORTS; p++) {
+            uint8_t buf[256];
+            size_t n;
+            while ((n = uart_rx_read(p, buf, sizeof(buf))) > 0) {
+                for (size_t i = 0; i < n; i++) {
+                    in_order[p] &= buf[i] == test_pattern(p, checked[p]++);
+                }
+            }
+        }
+        if (!first_done && (checked[0] == TEST_BYTES || checked[1] == TEST_BYTES)) {
+            first_done = true;
+            at_first_done[0] = checked[0];
+            at_first_done[1] = checked[1];
+        }
+    }
+    uint64_t elapsed = hal_time_us() - start;
+
+    for (uint32_t p = 0; p < UART_PORTS; p++) {
+        uart_rx_stats_t s;
+        uart_rx_get_stats(p, &s);
+        CHECK_EQ(checked[p], TEST_BYTES);
+        CHECK_EQ(s.received, TEST_BYTES);
+        CHECK(in_order[p]);
+        CHECK_EQ(s.overflows, 0);
+        CHECK_EQ(s.fifo_overruns, 0);
+        printf("uart%u: %u bytes, high water %u/%u, %u%% done when the first port finished\n", p,
+               s.received, s.high_water, UART_RX_BUF_SIZE,
+               (uint32_t)((uint64_t)at_first_done[p] * 100 / TEST_BYTES));
+        close(peer[p]);
+    }
+    uint32_t slower = at_first_done[0] < at_first_done[1] ? at_first_done[0] : at_first_done[1];
+    CHECK((uint64_t)slower * 100 >= (uint64_t)TEST_BYTES * TEST_MIN_SHARE);
+    printf("both ports: %.1f MB/s aggregate\n",
+           elapsed ? (double)UART_PORTS * TEST_BYTES / elapsed : 0.0);
+    return test_result();
+}
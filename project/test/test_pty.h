@@ -0,0 +1,40 @@
+#ifndef TEST_PTY_H
+#define TEST_PTY_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include "hal.h"
+#include "hal_host.h"
+
+// Helpers for the host tests and benchmarks that drive hal_host.c: a peer on
+// a UART's PTY, the bytes it sends, and a tick for the main loop.
+
+static int64_t test_tick(int32_t id, void *user_data) {
+    return -(int64_t)(uintptr_t)user_data;
+}
+
+// Keep hal_wait_for_event() from sleeping longer than period_us, since a test
+// driving the peer itself may have nothing else to wake it
+static inline void test_tick_start(uint64_t period_us) {
+    hal_alarm_in_us(period_us, test_tick, (void *)(uintptr_t)period_us);
+}
+
+// Byte i of test stream n. Doesn't repeat every 256 bytes, and streams
+// differ, so slips and crossed ports both show up as bad data.
+static inline uint8_t test_pattern(uint32_t stream, uint32_t i) {
+    return (uint8_t)(i * (2 * stream + 7) + (i >> 8) + stream);
+}
+
+// Open the peer end of a UART's PTY, non-blocking. -1 on failure.
+static inline int test_pty_open(uint32_t port) {
+    const char *name = hal_host_uart_pty(port);
+    int fd = name ? open(name, O_RDWR | O_NOCTTY | O_NONBLOCK) : -1;
+    if (fd < 0) {
+        perror("pty");
+    }
+    return fd;
+}
+
+#endif
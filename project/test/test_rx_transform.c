@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <string.h>
+#include "rx_transform.h"
+#include "rx_transform_ref.h"
+#include "test.h"
+
+// Checks the lookup table and both block kernels against the per-char
+// reference: every byte value in every lane and at every alignment, next to
+// every other byte value, then random buffers of every short length, also
+// transformed in place.
+
+#define TEST_BUF 16
+
+static uint32_t failures_map, failures_compact;
+
+// in[0..len) at any alignment, checked against the reference
+static void check(const uint8_t *in, size_t len) {
+    uint8_t want_map[64], want[64], out[64 + 8];
+    size_t want_n = 0;
+    for (size_t i = 0; i < len; i++) {
+        want_map[i] = rx_transform_ref(in[i]);
+        if (want_map[i]) {
+            want[want_n++] = want_map[i];
+        }
+    }
+
+    // Misalign the output relative to the input too
+    uint8_t *o = out + 1 + ((uintptr_t)in & 3);
+    rx_transform_map(in, o, len);
+    failures_map += memcmp(o, want_map, len) != 0;
+
+    size_t n = rx_transform(in, o, len);
+    failures_compact += n != want_n || memcmp(o, want, n) != 0;
+}
+
+int main(void) {
+    for (int c = 0; c < 256; c++) {
+        CHECK_EQ(rx_transform_lut[c], rx_transform_ref(c));
+        CHECK_EQ(rx_transform_byte(c), rx_transform_ref(c));
+    }
+
+    // Word storage so offsets 0..3 really are the four alignments
+    uint32_t words[TEST_BUF / 4 + 2];
+    uint8_t *base = (uint8_t *)words;
+    for (int v = 0; v < 256; v++) {
+        for (int w = 0; w < 256; w++) {
+            for (int align = 0; align < 4; align++) {
+                uint8_t *buf = base + align;
+                memset(buf, w, TEST_BUF);
+                for (int pos = 0; pos < TEST_BUF; pos++) {
+                    buf[pos] = v;
+                    check(buf, TEST_BUF);
+                    buf[pos] = w;
+                }
+            }
+        }
+    }
+
+    // Every length up to a few words, random content biased towards kept bytes
+    srand(1);
+    uint32_t big[20];
+    for (int iter = 0; iter < 20000; iter++) {
+        uint8_t *buf = (uint8_t *)big + iter % 4;
+        size_t len = iter % 64;
+        for (size_t i = 0; i < len; i++) {
+            int r = rand();
+            buf[i] = r & 0x100 ? 'A' + r % 26 : r & 0x200 ? '1' : (uint8_t)r;
+        }
+        check(buf, len);
+
+        // In place, as app_poll() does it
+        uint8_t copy[64];
+        memcpy(copy, buf, len);
+        size_t want_n = 0;
+        uint8_t want[64];
+        for (size_t i = 0; i < len; i++) {
+            if (rx_transform_ref(copy[i])) {
+                want[want_n++] = rx_transform_ref(copy[i]);
+            }
+        }
+        size_t n = rx_transform(buf, buf, len);
+        CHECK(n == want_n && memcmp(buf, want, n) == 0);
+
+        memcpy(buf, copy, len);
+        rx_transform_map(buf, buf, len);
+        for (size_t i = 0; i < len; i++) {
+            failures_map += buf[i] != rx_transform_ref(copy[i]);
+        }
+    }
+
+    CHECK_EQ(failures_map, 0);
+    CHECK_EQ(failures_compact, 0);
+    return test_result();
+}
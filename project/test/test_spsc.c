@@ -0,0 +1,59 @@
+#include <pthread.h>
+#include <sched.h>
+#include "spsc_queue.h"
+#include "test.h"
+
+// One producer and one consumer thread push a counting sequence through the
+// queue as fast as they can. The consumer checks that every value arrives
+// once and in order; the run reports throughput.
+
+#define TEST_ITEMS 2000000u
+#define TEST_QUEUE_SIZE 256 // same as the core1 -> core0 queue
+
+static uint32_t storage[TEST_QUEUE_SIZE];
+static spsc_queue_t queue;
+
+static void *producer(void *arg) {
+    for (uint32_t i = 0; i < TEST_ITEMS; i++) {
+        while (!spsc_queue_push(&queue, i)) {
+            sched_yield(); // full, let the consumer run (matters on one CPU)
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    // Indices start near the wrap so it is crossed during the run
+    spsc_queue_init(&queue, storage, TEST_QUEUE_SIZE);
+    atomic_store(&queue.head, UINT32_MAX - TEST_ITEMS / 2);
+    atomic_store(&queue.tail, UINT32_MAX - TEST_ITEMS / 2);
+    queue.head_cache = queue.tail_cache = UINT32_MAX - TEST_ITEMS / 2;
+
+    CHECK_EQ(spsc_queue_free(&queue), TEST_QUEUE_SIZE);
+
+    uint64_t start = test_now_ns();
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, producer, NULL) == 0);
+
+    uint32_t expected = 0;
+    uint32_t out_of_order = 0;
+    while (expected < TEST_ITEMS) {
+        uint32_t value;
+        if (!spsc_queue_pop(&queue, &value)) {
+            sched_yield();
+            continue;
+        }
+        out_of_order += value != expected;
+        expected++;
+    }
+    pthread_join(thread, NULL);
+    uint64_t elapsed_ns = test_now_ns() - start;
+
+    uint32_t value;
+    CHECK(!spsc_queue_pop(&queue, &value));
+    CHECK_EQ(out_of_order, 0);
+    CHECK_EQ(spsc_queue_free(&queue), TEST_QUEUE_SIZE);
+    printf("spsc: %u items in %.1f ms, %.1f Mitems/s\n", TEST_ITEMS, elapsed_ns / 1e6,
+           TEST_ITEMS * 1e3 / elapsed_ns);
+    return test_result();
+}
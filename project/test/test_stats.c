@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include <string.h>
+#include "stats.h"
+#include "test.h"
+
+// Histogram math: bucket edges including the open-ended last bucket, the
+// count/sum/max kept next to the buckets, and stats_format() output at every
+// buffer size down to truncation.
+
+static void test_buckets(void) {
+    CHECK_EQ(stats_bucket(0), 0);
+    CHECK_EQ(stats_bucket(1), 1);
+    for (uint32_t k = 1; k < STATS_BUCKETS - 1; k++) {
+        // bucket k holds [2^(k-1), 2^k)
+        CHECK_EQ(stats_bucket(1u << (k - 1)), k);
+        CHECK_EQ(stats_bucket((1u << k) - 1), k);
+    }
+    CHECK_EQ(stats_bucket(1u << (STATS_BUCKETS - 2)), STATS_BUCKETS - 1);
+    CHECK_EQ(stats_bucket(1u << (STATS_BUCKETS - 1)), STATS_BUCKETS - 1);
+    CHECK_EQ(stats_bucket(UINT32_MAX), STATS_BUCKETS - 1);
+}
+
+static void test_record(void) {
+    const uint32_t samples[] = {0, 1, 2, 3, 4, 1000, 1023, 1024, 1u << 20, UINT32_MAX};
+    const size_t n = sizeof(samples) / sizeof(samples[0]);
+    uint32_t want[STATS_BUCKETS] = {0};
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        stats_record(STATS_LOG_DRAIN, samples[i]);
+        want[stats_bucket(samples[i])]++;
+        sum += samples[i];
+    }
+
+    stats_histogram_t h;
+    stats_get(STATS_LOG_DRAIN, &h);
+    CHECK_EQ(h.count, n);
+    CHECK_EQ(h.sum_us, sum); // 64-bit, doesn't wrap on UINT32_MAX
+    CHECK_EQ(h.max_us, UINT32_MAX);
+    CHECK(memcmp(h.buckets, want, sizeof(want)) == 0);
+    CHECK_EQ(h.buckets[0], 1);
+    CHECK_EQ(h.buckets[2], 2);  // 2, 3
+    CHECK_EQ(h.buckets[10], 2); // 1000, 1023
+    CHECK_EQ(h.buckets[11], 1); // 1024
+    CHECK_EQ(h.buckets[STATS_BUCKETS - 1], 2); // 2^20 and UINT32_MAX, open ended
+
+    // Other histograms untouched
+    stats_get(STATS_BTN_TO_TX, &h);
+    CHECK_EQ(h.count, 0);
+}
+
+static void test_format(void) {
+    stats_inc(STATS_RX_IDLE);
+    stats_inc(STATS_RX_IDLE);
+
+    char full[2048];
+    size_t len = stats_format(full, sizeof(full));
+    CHECK_EQ(len, strlen(full));
+    CHECK(len > 4 && strcmp(full + len - 4, "end\n") == 0);
+    CHECK(strstr(full, "rxidle=2 ") != NULL);
+    CHECK(strstr(full, "uart1 tx=0 ") != NULL);
+
+    char line[256];
+    snprintf(line, sizeof(line), "log_drain n=10 sum=%llu max=%lu b=1,1,2,",
+             (unsigned long long)(0 + 1 + 2 + 3 + 4 + 1000 + 1023 + 1024 + (1u << 20) + (uint64_t)UINT32_MAX),
+             (unsigned long)UINT32_MAX);
+    CHECK(strstr(full, line) != NULL);
+    CHECK(strstr(full, ",2\nend\n") != NULL); // last bucket of the last histogram
+
+    // Every truncation is a prefix of the full report, length excluding the NUL
+    for (size_t size = 1; size <= len + 1; size++) {
+        char *buf = malloc(size);
+        size_t n = stats_format(buf, size);
+        size_t want = len < size ? len : size - 1;
+        CHECK_EQ(n, want);
+        CHECK_EQ(strlen(buf), want);
+        CHECK(memcmp(buf, full, want) == 0);
+        free(buf);
+    }
+    CHECK_EQ(stats_format(full, 0), 0);
+}
+
+int main(void) {
+    stats_init();
+    test_buckets();
+    test_record();
+    test_format();
+    return test_result();
+}
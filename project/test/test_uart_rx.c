@@ -0,0 +1,116 @@
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include "test.h"
+#include "test_pty.h"
+#include "uart_rx.h"
+
+// Streams bursts into UART1's PTY paced at the configured baud and checks the
+// RX engine keeps every byte, in order. Then overfills the ring without
+// reading to check the overflow and high-water counters.
+
+#define TEST_PORT 1
+#define TEST_BAUD 115200
+#define TEST_BURST 768 // most of the ring, so the main loop has to keep up
+#define TEST_BURSTS 16
+#define TEST_TICK_US 200
+
+// Let the host HAL deliver what the peer wrote, until the engine has seen
+// total bytes or a second passes
+static void dispatch_until(uint32_t total) {
+    uint64_t deadline = hal_time_us() + 1000000;
+    uart_rx_stats_t s;
+    do {
+        hal_wait_for_event();
+        uart_rx_get_stats(TEST_PORT, &s);
+    } while (s.received + s.overflows < total && hal_time_us() < deadline);
+}
+
+static void test_bursts(int peer) {
+    uint32_t sent = 0;
+    uint32_t checked = 0;
+    bool in_order = true;
+
+    for (int b = 0; b < TEST_BURSTS; b++) {
+        // One burst at line rate: 10 bits per byte on the wire
+        uint64_t start = hal_time_us();
+        uint32_t burst_end = sent + TEST_BURST;
+        while (sent < burst_end) {
+            uint64_t due = (hal_time_us() - start) * TEST_BAUD / 10 / 1000000;
+            uint8_t chunk[64];
+            uint32_t n = 0;
+            while (sent + n < burst_end && sent + n - (burst_end - TEST_BURST) < due && n < sizeof(chunk)) {
+                chunk[n] = test_pattern(0, sent + n);
+                n++;
+            }
+            if (n && write(peer, chunk, n) == (ssize_t)n) {
+                sent += n;
+            }
+            hal_wait_for_event();
+        }
+        dispatch_until(sent);
+
+        // Main loop side, once per burst
+        uint8_t buf[256];
+        size_t n;
+        while ((n = uart_rx_read(TEST_PORT, buf, sizeof(buf))) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                in_order &= buf[i] == test_pattern(0, checked++);
+            }
+        }
+    }
+
+    uart_rx_stats_t s;
+    uart_rx_get_stats(TEST_PORT, &s);
+    CHECK_EQ(checked, sent);
+    CHECK_EQ(s.received, sent);
+    CHECK(in_order);
+    CHECK_EQ(s.overflows, 0);
+    CHECK_EQ(s.fifo_overruns, 0);
+    CHECK(s.high_water >= TEST_BURST && s.high_water <= UART_RX_BUF_SIZE);
+    printf("bursts: %u bytes at %u baud, high water %u/%u\n", sent, TEST_BAUD,
+           s.high_water, UART_RX_BUF_SIZE);
+}
+
+static void test_overflow(int peer) {
+    uart_rx_stats_t before;
+    uart_rx_get_stats(TEST_PORT, &before);
+
+    const uint32_t excess = 100;
+    uint8_t data[UART_RX_BUF_SIZE + 100];
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = test_pattern(0, i);
+    }
+    CHECK_EQ(write(peer, data, sizeof(data)), sizeof(data));
+    dispatch_until(before.received + before.overflows + sizeof(data));
+
+    uart_rx_stats_t s;
+    uart_rx_get_stats(TEST_PORT, &s);
+    CHECK_EQ(s.received - before.received, UART_RX_BUF_SIZE);
+    CHECK_EQ(s.overflows - before.overflows, excess);
+    CHECK_EQ(s.high_water, UART_RX_BUF_SIZE);
+
+    // The ring keeps the oldest bytes, the excess is what got dropped
+    uint8_t buf[UART_RX_BUF_SIZE + 100];
+    CHECK_EQ(uart_rx_read(TEST_PORT, buf, sizeof(buf)), UART_RX_BUF_SIZE);
+    CHECK(memcmp(buf, data, UART_RX_BUF_SIZE) == 0);
+}
+
+int main(void) {
+    uart_ports[0].mode = UART_PORT_OFF;
+    uart_ports[TEST_PORT].baud = TEST_BAUD;
+    uart_ports_init();
+    uart_rx_init(TEST_PORT);
+    test_tick_start(TEST_TICK_US);
+
+    int peer = test_pty_open(TEST_PORT);
+    CHECK(peer >= 0);
+    if (peer < 0) {
+        return test_result();
+    }
+
+    test_bursts(peer);
+    test_overflow(peer);
+    close(peer);
+    return test_result();
+}
@@ -0,0 +1,181 @@
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+#include "test_pty.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+
+// Ring writes and buffers sent in place, mixed on one port, against a peer
+// that reads slowly so transfers back up: the peer must see one stream in the
+// order it was queued, and no buffer may be released before it is sent. Then
+// queues buffers until UART_TX_REFS of them are waiting, for the drop path.
+// Also reads the RX ring in place across its wrap.
+
+#define TEST_PORT 1
+#define TEST_TICK_US 200
+#define TEST_BYTES (256 * 1024)
+#define TEST_RING_CHUNK 100
+#define TEST_REF_CHUNK 300
+#define TEST_BIG_REF (16 * 1024) // enough to fill the PTY with UART_TX_REFS of them
+
+typedef struct {
+    uint8_t data[TEST_BIG_REF];
+    bool busy; // queued, not yet released
+} ref_slot_t;
+
+static ref_slot_t slots[UART_TX_REFS + 1];
+static uint32_t released;
+
+static void on_release(void *ctx) {
+    ref_slot_t *slot = ctx;
+    CHECK(slot->busy);
+    memset(slot->data, 0xEE, sizeof(slot->data)); // a release before the send would show as bad data
+    slot->busy = false;
+    released++;
+}
+
+static ref_slot_t *free_slot(void) {
+    for (size_t i = 0; i < sizeof(slots) / sizeof(slots[0]); i++) {
+        if (!slots[i].busy) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    int fd;
+    uint32_t received;
+    uint32_t bad;
+} peer_t;
+
+static void peer_read(peer_t *peer, size_t max) {
+    uint8_t buf[4096];
+    ssize_t n = read(peer->fd, buf, max < sizeof(buf) ? max : sizeof(buf));
+    for (ssize_t i = 0; i < n; i++) {
+        peer->bad += buf[i] != test_pattern(0, peer->received++);
+    }
+}
+
+static void test_mixed(peer_t *peer) {
+    uint32_t queued = 0, refs = 0;
+    bool ring_turn = true;
+    uint64_t deadline = hal_time_us() + 20000000;
+    while (peer->received < TEST_BYTES && hal_time_us() < deadline) {
+        uint32_t n = ring_turn ? TEST_RING_CHUNK : TEST_REF_CHUNK;
+        n = TEST_BYTES - queued < n ? TEST_BYTES - queued : n;
+        if (n && ring_turn && uart_tx_free(TEST_PORT) >= n) {
+            uint8_t chunk[TEST_RING_CHUNK];
+            for (uint32_t i = 0; i < n; i++) {
+                chunk[i] = test_pattern(0, queued + i);
+            }
+            CHECK(uart_tx_write(TEST_PORT, chunk, n));
+            queued += n;
+            ring_turn = false;
+        } else if (n && !ring_turn && uart_tx_refs_free(TEST_PORT) > 0 && free_slot()) {
+            ref_slot_t *slot = free_slot();
+            for (uint32_t i = 0; i < n; i++) {
+                slot->data[i] = test_pattern(0, queued + i);
+            }
+            slot->busy = true;
+            CHECK(uart_tx_write_ref(TEST_PORT, slot->data, n, on_release, slot));
+            queued += n;
+            refs++;
+            ring_turn = true;
+        }
+        hal_wait_for_event();
+        peer_read(peer, 64); // slower than the writes, so the PTY fills
+    }
+
+    CHECK_EQ(peer->received, TEST_BYTES);
+    CHECK_EQ(peer->bad, 0);
+    CHECK_EQ(released, refs);
+    CHECK_EQ(uart_tx_bytes(TEST_PORT), TEST_BYTES);
+    CHECK_EQ(uart_tx_dropped(TEST_PORT), 0);
+    printf("mixed: %u bytes, %u buffers sent in place\n", peer->received, refs);
+}
+
+static void test_refs_full(peer_t *peer) {
+    // Nobody reads, so the first buffer stalls in the PTY and the rest wait
+    uint32_t queued = 0, refs = 0;
+    ref_slot_t *slot;
+    while ((slot = free_slot()) && uart_tx_refs_free(TEST_PORT) > 0) {
+        for (uint32_t i = 0; i < TEST_BIG_REF; i++) {
+            slot->data[i] = test_pattern(0, peer->received + queued + i);
+        }
+        slot->busy = true;
+        CHECK(uart_tx_write_ref(TEST_PORT, slot->data, TEST_BIG_REF, on_release, slot));
+        queued += TEST_BIG_REF;
+        refs++;
+    }
+    CHECK_EQ(uart_tx_refs_free(TEST_PORT), 0);
+    CHECK(slot != NULL); // the queue filled before the slots ran out
+    CHECK(!uart_tx_write_ref(TEST_PORT, slots[0].data, 1, on_release, NULL));
+    CHECK_EQ(uart_tx_dropped(TEST_PORT), 1);
+
+    uint32_t end = peer->received + queued;
+    uint32_t released_before = released;
+    uint64_t deadline = hal_time_us() + 10000000;
+    while (peer->received < end && hal_time_us() < deadline) {
+        hal_wait_for_event();
+        peer_read(peer, SIZE_MAX);
+    }
+    CHECK_EQ(peer->received, end);
+    CHECK_EQ(peer->bad, 0);
+    CHECK_EQ(released - released_before, refs);
+    CHECK_EQ(uart_tx_refs_free(TEST_PORT), UART_TX_REFS);
+}
+
+static void test_rx_peek(peer_t *peer) {
+    // Leave the ring's tail 10 bytes short of the wrap
+    uint8_t fill[UART_RX_BUF_SIZE - 10];
+    memset(fill, 'x', sizeof(fill));
+    CHECK_EQ(write(peer->fd, fill, sizeof(fill)), sizeof(fill));
+    uint64_t deadline = hal_time_us() + 1000000;
+    while (uart_rx_available(TEST_PORT) < sizeof(fill) && hal_time_us() < deadline) {
+        hal_wait_for_event();
+    }
+    uint8_t *data;
+    CHECK_EQ(uart_rx_peek(TEST_PORT, &data, SIZE_MAX), sizeof(fill));
+    uart_rx_consume(TEST_PORT, sizeof(fill));
+
+    uint8_t msg[30];
+    for (uint32_t i = 0; i < sizeof(msg); i++) {
+        msg[i] = test_pattern(1, i);
+    }
+    CHECK_EQ(write(peer->fd, msg, sizeof(msg)), sizeof(msg));
+    deadline = hal_time_us() + 1000000;
+    while (uart_rx_available(TEST_PORT) < sizeof(msg) && hal_time_us() < deadline) {
+        hal_wait_for_event();
+    }
+
+    // In place: up to the wrap, then the rest from the start of the ring
+    CHECK_EQ(uart_rx_peek(TEST_PORT, &data, 4), 4);
+    CHECK(memcmp(data, msg, 4) == 0);
+    CHECK_EQ(uart_rx_peek(TEST_PORT, &data, SIZE_MAX), 10);
+    CHECK(memcmp(data, msg, 10) == 0);
+    uart_rx_consume(TEST_PORT, 10);
+    CHECK_EQ(uart_rx_peek(TEST_PORT, &data, SIZE_MAX), 20);
+    CHECK(memcmp(data, msg + 10, 20) == 0);
+    uart_rx_consume(TEST_PORT, 20);
+    CHECK_EQ(uart_rx_peek(TEST_PORT, &data, SIZE_MAX), 0);
+}
+
+int main(void) {
+    uart_ports[0].mode = UART_PORT_OFF;
+    uart_ports_init();
+    uart_rx_init(TEST_PORT);
+    test_tick_start(TEST_TICK_US);
+
+    peer_t peer = {test_pty_open(TEST_PORT)};
+    CHECK(peer.fd >= 0);
+    if (peer.fd < 0) {
+        return test_result();
+    }
+
+    test_mixed(&peer);
+    test_refs_full(&peer);
+    test_rx_peek(&peer);
+    close(peer.fd);
+    return test_result();
+}
@@ -0,0 +1,34 @@
+#include "uart_port.h"
+#include "hal.h"
+
+#if (UART_RX_BUF_SIZE & (UART_RX_BUF_SIZE - 1)) != 0
+#error "UART_RX_BUF_SIZE must be a power of two"
+#endif
+#if (UART_TX_BUF_SIZE & (UART_TX_BUF_SIZE - 1)) != 0
+#error "UART_TX_BUF_SIZE must be a power of two"
+#endif
+#if (UART_TX_REFS & (UART_TX_REFS - 1)) != 0
+#error "UART_TX_REFS must be a power of two"
+#endif
+
+uart_port_t uart_ports[UART_PORTS] = {
+    // UART0 on GP0/GP1, free now that stdio is USB only
+    [0] = {.tx_pin = 0, .rx_pin = 1, .baud = 9600, .mode = UART_PORT_LEGACY},
+    // UART1 on GP8/GP9
+    [1] = {.tx_pin = 8, .rx_pin = 9, .baud = 9600, .mode = UART_PORT_LEGACY},
+};
+
+static uint8_t rx_storage[UART_PORTS][UART_RX_BUF_SIZE];
+static uint8_t tx_storage[UART_PORTS][UART_TX_BUF_SIZE];
+
+void uart_ports_init(void) {
+    for (uint32_t i = 0; i < UART_PORTS; i++) {
+        uart_port_t *p = &uart_ports[i];
+        if (p->mode == UART_PORT_OFF) {
+            continue;
+        }
+        ring_buf_init(&p->rx, rx_storage[i], UART_RX_BUF_SIZE);
+        ring_buf_init(&p->tx, tx_storage[i], UART_TX_BUF_SIZE);
+        hal_uart_init(i, p->baud, p->tx_pin, p->rx_pin);
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef UART_PORT_H
+#define UART_PORT_H
+
+#include <stdint.h>
+#include "ring_buf.h"
+
+// Port table: one entry per hardware UART with its pins, baud, link mode and
+// RX/TX rings. uart_rx.c fills the RX ring from the UART IRQ, uart_tx.c
+// drains the TX ring, and any buffers queued to be sent in place, through DMA.
+
+#define UART_PORTS 2
+
+// Receive ring size in bytes per port, must be a power of two.
+#ifndef UART_RX_BUF_SIZE
+#define UART_RX_BUF_SIZE 1024
+#endif
+
+// Transmit queue size in bytes per port, must be a power of two.
+#ifndef UART_TX_BUF_SIZE
+#define UART_TX_BUF_SIZE 1024
+#endif
+
+// Buffers queued per port to be sent in place, must be a power of two.
+#ifndef UART_TX_REFS
+#define UART_TX_REFS 8
+#endif
+
+typedef enum {
+    UART_PORT_OFF,
+    UART_PORT_LEGACY, // one raw char per event, for old peers
+    UART_PORT_FRAMED, // events batched into COBS frames with seq and CRC, see frame.h
+} uart_port_mode_t;
+
+typedef struct {
+    uint32_t received;    // bytes taken from the hardware FIFO
+    uint32_t overflows;   // bytes dropped because the ring was full
+    uint32_t fifo_overruns; // bytes lost by the hardware FIFO before the IRQ ran
+    uint32_t high_water;  // highest ring fill level seen
+} uart_rx_stats_t;
+
+// Called once a buffer queued with uart_tx_write_ref() has been sent
+typedef void (*uart_tx_release_cb_t)(void *ctx);
+
+typedef struct {
+    const uint8_t *buf;
+    uint32_t len;
+    uint32_t ring_mark; // TX ring head when queued: ring bytes before it go first
+    uart_tx_release_cb_t release;
+    void *ctx;
+} uart_tx_ref_t;
+
+typedef struct {
+    uint8_t tx_pin;
+    uint8_t rx_pin;
+    uint32_t baud;
+    volatile uart_port_mode_t mode;
+
+    ring_buf_t rx;
+    uart_rx_stats_t rx_stats;
+    volatile uint64_t rx_arrival_us; // when the RX ring last went from empty to not
+
+    ring_buf_t tx;
+    uart_tx_ref_t tx_refs[UART_TX_REFS];
+    volatile uint32_t tx_ref_head; // free-running like the ring indices
+    volatile uint32_t tx_ref_tail;
+    volatile uint32_t tx_inflight; // bytes handed to the current transfer
+    volatile bool tx_ref_inflight; // the current transfer is tx_refs[tail]
+    volatile uint32_t tx_drops;
+    volatile uint32_t tx_bytes;
+} uart_port_t;
+
+extern uart_port_t uart_ports[UART_PORTS];
+
+// Set up pins, baud and rings of every port that isn't UART_PORT_OFF. RX
+// interrupts are started separately with uart_rx_init(), on the core that
+// should service them.
+void uart_ports_init(void);
+
+#endif
@@ -0,0 +1,58 @@
+#include "uart_rx.h"
+#include "hal.h"
+
+// Runs in the UART RX IRQ for every byte taken from the FIFO
+static void uart_rx_on_byte(uint32_t port, uint8_t c, bool fifo_overrun) {
+    uart_port_t *p = &uart_ports[port];
+
+    if (fifo_overrun) {
+        p->rx_stats.fifo_overruns++;
+    }
+    if (ring_buf_count(&p->rx) == 0) {
+        p->rx_arrival_us = hal_time_us();
+    }
+    if (ring_buf_put(&p->rx, c)) {
+        p->rx_stats.received++;
+    } else {
+        p->rx_stats.overflows++;
+    }
+
+    uint32_t level = ring_buf_count(&p->rx);
+    if (level > p->rx_stats.high_water) {
+        p->rx_stats.high_water = level;
+    }
+}
+
+void uart_rx_init(uint32_t port) {
+    hal_uart_set_rx_handler(port, uart_rx_on_byte);
+}
+
+size_t uart_rx_read(uint32_t port, uint8_t *dst, size_t len) {
+    return ring_buf_read(&uart_ports[port].rx, dst, len);
+}
+
+size_t uart_rx_peek(uint32_t port, uint8_t **data, size_t len) {
+    size_t n = ring_buf_peek(&uart_ports[port].rx, data);
+    return n < len ? n : len;
+}
+
+void uart_rx_consume(uint32_t port, size_t len) {
+    ring_buf_consume(&uart_ports[port].rx, len);
+}
+
+size_t uart_rx_available(uint32_t port) {
+    return ring_buf_count(&uart_ports[port].rx);
+}
+
+uint64_t uart_rx_arrival_us(uint32_t port) {
+    uint32_t save = hal_irq_save();
+    uint64_t t = uart_ports[port].rx_arrival_us;
+    hal_irq_restore(save);
+    return t;
+}
+
+void uart_rx_get_stats(uint32_t port, uart_rx_stats_t *stats) {
+    uint32_t save = hal_irq_save();
+    *stats = uart_ports[port].rx_stats;
+    hal_irq_restore(save);
+}
@@ -0,0 +1,30 @@
+#ifndef UART_RX_H
+#define UART_RX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "uart_port.h"
+
+// Start draining the port's RX FIFO into its ring from the UART IRQ.
+// The port must already be set up with uart_ports_init().
+void uart_rx_init(uint32_t port);
+
+// Copy up to len buffered bytes into dst. Returns the number copied.
+size_t uart_rx_read(uint32_t port, uint8_t *dst, size_t len);
+
+// Read in place instead: points *data at up to len of the oldest buffered
+// bytes, contiguous in the ring, and returns how many. The caller may read
+// and rewrite them until it hands them back with uart_rx_consume().
+size_t uart_rx_peek(uint32_t port, uint8_t **data, size_t len);
+void uart_rx_consume(uint32_t port, size_t len);
+
+size_t uart_rx_available(uint32_t port);
+
+// Arrival time of the oldest unread byte, as of when the ring last went from
+// empty to non-empty
+uint64_t uart_rx_arrival_us(uint32_t port);
+
+void uart_rx_get_stats(uint32_t port, uart_rx_stats_t *stats);
+
+#endif
@@ -0,0 +1,109 @@
+#include "uart_tx.h"
+#include "hal.h"
+
+static void uart_tx_kick(uint32_t port);
+
+// IRQ context on the Pico: the in-flight bytes are gone, send what's next
+static void uart_tx_done(uint32_t port) {
+    uart_port_t *p = &uart_ports[port];
+    uart_tx_release_cb_t release = NULL;
+    void *ctx = NULL;
+    if (p->tx_ref_inflight) {
+        uart_tx_ref_t *r = &p->tx_refs[p->tx_ref_tail & (UART_TX_REFS - 1)];
+        release = r->release;
+        ctx = r->ctx;
+        p->tx_ref_tail++;
+        p->tx_ref_inflight = false;
+    } else {
+        p->tx.tail += p->tx_inflight;
+    }
+    p->tx_inflight = 0;
+    uart_tx_kick(port);
+    if (release) {
+        release(ctx);
+    }
+}
+
+// Start a transfer for the next queued buffer, or for the contiguous run of
+// ring bytes queued ahead of it. Call with IRQs masked.
+static void uart_tx_kick(uint32_t port) {
+    uart_port_t *p = &uart_ports[port];
+    if (p->tx_inflight) {
+        return;
+    }
+    uint32_t end = p->tx.head;
+    if (p->tx_ref_tail != p->tx_ref_head) {
+        uart_tx_ref_t *r = &p->tx_refs[p->tx_ref_tail & (UART_TX_REFS - 1)];
+        if (p->tx.tail == r->ring_mark) {
+            p->tx_ref_inflight = true;
+            p->tx_inflight = r->len;
+            hal_uart_tx_start(port, r->buf, r->len, uart_tx_done);
+            return;
+        }
+        end = r->ring_mark;
+    }
+    uint32_t count = end - p->tx.tail;
+    if (count == 0) {
+        return;
+    }
+    uint32_t start = p->tx.tail & p->tx.mask;
+    uint32_t run = p->tx.mask + 1 - start; // stop at the wrap
+    p->tx_inflight = count < run ? count : run;
+    hal_uart_tx_start(port, &p->tx.buf[start], p->tx_inflight, uart_tx_done);
+}
+
+bool uart_tx_write(uint32_t port, const uint8_t *buf, size_t len) {
+    uart_port_t *p = &uart_ports[port];
+    uint32_t save = hal_irq_save();
+    bool ok = ring_buf_free(&p->tx) >= len;
+    if (ok) {
+        for (size_t i = 0; i < len; i++) {
+            ring_buf_put(&p->tx, buf[i]);
+        }
+        p->tx_bytes += len;
+        uart_tx_kick(port);
+    } else {
+        p->tx_drops++;
+    }
+    hal_irq_restore(save);
+    return ok;
+}
+
+bool uart_tx_write_ref(uint32_t port, const uint8_t *buf, size_t len,
+                       uart_tx_release_cb_t release, void *ctx) {
+    uart_port_t *p = &uart_ports[port];
+    uint32_t save = hal_irq_save();
+    bool ok = p->tx_ref_head - p->tx_ref_tail < UART_TX_REFS;
+    if (ok) {
+        uart_tx_ref_t *r = &p->tx_refs[p->tx_ref_head & (UART_TX_REFS - 1)];
+        r->buf = buf;
+        r->len = len;
+        r->ring_mark = p->tx.head;
+        r->release = release;
+        r->ctx = ctx;
+        p->tx_ref_head++;
+        p->tx_bytes += len;
+        uart_tx_kick(port);
+    } else {
+        p->tx_drops++;
+    }
+    hal_irq_restore(save);
+    return ok;
+}
+
+uint32_t uart_tx_free(uint32_t port) {
+    return ring_buf_free(&uart_ports[port].tx);
+}
+
+uint32_t uart_tx_refs_free(uint32_t port) {
+    uart_port_t *p = &uart_ports[port];
+    return UART_TX_REFS - (p->tx_ref_head - p->tx_ref_tail);
+}
+
+uint32_t uart_tx_bytes(uint32_t port) {
+    return uart_ports[port].tx_bytes;
+}
+
+uint32_t uart_tx_dropped(uint32_t port) {
+    return uart_ports[port].tx_drops;
+}
@@ -0,0 +1,40 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "uart_port.h"
+
+// Queue bytes on a port's TX ring, or buffers to be sent in place; both are
+// drained in the background, in the order queued, through
+// hal_uart_tx_start(). The port must already be set up with uart_ports_init().
+
+// Queue len bytes, all or nothing. Never blocks: returns false and counts a
+// drop if there isn't room. Safe from IRQ context.
+bool uart_tx_write(uint32_t port, const uint8_t *buf, size_t len);
+
+static inline bool uart_tx_putc(uint32_t port, char c) {
+    return uart_tx_write(port, (const uint8_t *)&c, 1);
+}
+
+// Queue len (> 0) bytes to be sent straight from buf, without copying. buf
+// must stay valid until release(ctx) is called, in IRQ context on the Pico,
+// once the transfer has read it; release may be NULL. Never blocks: returns
+// false and counts a drop if UART_TX_REFS buffers are already queued. Safe
+// from IRQ context.
+bool uart_tx_write_ref(uint32_t port, const uint8_t *buf, size_t len,
+                       uart_tx_release_cb_t release, void *ctx);
+
+// Room left in the queue
+uint32_t uart_tx_free(uint32_t port);
+
+// Buffers uart_tx_write_ref() can still queue
+uint32_t uart_tx_refs_free(uint32_t port);
+
+// Bytes accepted into the queue
+uint32_t uart_tx_bytes(uint32_t port);
+
+uint32_t uart_tx_dropped(uint32_t port);
+
+#endif
@@ -0,0 +1,178 @@
+#include <string.h>
+#include "udp_bridge.h"
+#include "hal.h"
+#include "uart_tx.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+
+// With the threadsafe background cyw43 arch lwIP runs from an IRQ, so calls
+// into it from the main loop must hold its lock. The host build is NO_SYS
+// on a single thread.
+#ifdef LIB_PICO_CYW43_ARCH
+#include "pico/cyw43_arch.h"
+#define bridge_lwip_begin() cyw43_arch_lwip_begin()
+#define bridge_lwip_end() cyw43_arch_lwip_end()
+#else
+#define bridge_lwip_begin() ((void)0)
+#define bridge_lwip_end() ((void)0)
+#endif
+
+static struct udp_pcb *bridge_pcb;
+static uint32_t bridge_uart;
+static ip_addr_t bridge_peer;
+static uint16_t bridge_peer_port;
+static udp_bridge_stats_t bridge_stats;
+
+static struct pbuf *tx_pbuf; // datagram being filled, NULL if none
+static uint16_t tx_fill;
+static uint64_t tx_first_us;
+
+// Datagrams from the peer are held until the UART has sent them. Once sent
+// they are handed back here from the DMA IRQ, and freed by udp_bridge_poll()
+// in lwIP's context, as lwIP can't be called from the IRQ.
+static struct pbuf *rx_sent[UART_TX_REFS];
+static volatile uint32_t rx_sent_head; // DMA IRQ
+static volatile uint32_t rx_sent_tail; // udp_bridge_poll
+static uint32_t rx_held; // datagrams queued and not yet freed, at most UART_TX_REFS
+
+// Only here to wake the main loop when a flush is due
+static int64_t udp_bridge_wake(int32_t id, void *user_data) {
+    return 0;
+}
+
+static void udp_bridge_flush(void) {
+    uint64_t late_us = hal_time_us() - tx_first_us;
+    if (late_us > 2 * UDP_BRIDGE_FLUSH_US) {
+        bridge_stats.tx_late++;
+    }
+
+    bridge_lwip_begin();
+    pbuf_realloc(tx_pbuf, tx_fill); // trim to what was filled, no copy
+    err_t err = udp_sendto(bridge_pcb, tx_pbuf, &bridge_peer, bridge_peer_port);
+    pbuf_free(tx_pbuf);
+    bridge_lwip_end();
+
+    if (err == ERR_OK) {
+        bridge_stats.tx_datagrams++;
+        bridge_stats.tx_bytes += tx_fill;
+    } else {
+        bridge_stats.tx_dropped += tx_fill;
+    }
+    tx_pbuf = NULL;
+}
+
+// UART TX, IRQ context on the Pico: the datagram has been sent
+static void udp_bridge_rx_sent(void *ctx) {
+    rx_sent[rx_sent_head & (UART_TX_REFS - 1)] = ctx;
+    __atomic_signal_fence(__ATOMIC_RELEASE);
+    rx_sent_head++;
+}
+
+// lwIP context: queue the datagram for UART TX as its pbuf chain, one buffer
+// per segment, sent in place. The chain is kept until the last segment is
+// out. All or nothing, so the peer never sees half a datagram.
+static void udp_bridge_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                            const ip_addr_t *addr, u16_t port) {
+    struct pbuf *last = NULL;
+    uint32_t segments = 0;
+    for (struct pbuf *q = p; q; q = q->next) {
+        if (q->len) {
+            last = q;
+            segments++;
+        }
+    }
+
+    uint32_t save = hal_irq_save();
+    bool ok = last && rx_held < UART_TX_REFS && uart_tx_refs_free(bridge_uart) >= segments;
+    if (ok) {
+        for (struct pbuf *q = p; q; q = q->next) {
+            if (q->len) {
+                uart_tx_write_ref(bridge_uart, q->payload, q->len,
+                                  q == last ? udp_bridge_rx_sent : NULL, p);
+            }
+        }
+        rx_held++;
+        bridge_stats.rx_datagrams++;
+        bridge_stats.rx_bytes += p->tot_len;
+    } else {
+        bridge_stats.rx_dropped++;
+    }
+    hal_irq_restore(save);
+    if (!ok) {
+        pbuf_free(p);
+    }
+}
+
+bool udp_bridge_init(uint32_t uart_port, const ip_addr_t *peer, uint16_t peer_port, uint16_t local_port) {
+    bridge_uart = uart_port;
+    ip_addr_copy(bridge_peer, *peer);
+    bridge_peer_port = peer_port;
+
+    bridge_lwip_begin();
+    bridge_pcb = udp_new();
+    bool ok = bridge_pcb && udp_bind(bridge_pcb, IP_ANY_TYPE, local_port) == ERR_OK;
+    if (ok) {
+        udp_recv(bridge_pcb, udp_bridge_recv, NULL);
+    }
+    bridge_lwip_end();
+    return ok;
+}
+
+void udp_bridge_feed(uint32_t uart_port, const uint8_t *data, size_t len) {
+    if (!bridge_pcb || uart_port != bridge_uart) {
+        return;
+    }
+    while (len > 0) {
+        if (!tx_pbuf) {
+            // Reserve transport header room so udp_sendto can prepend in place
+            bridge_lwip_begin();
+            tx_pbuf = pbuf_alloc(PBUF_TRANSPORT, UDP_BRIDGE_MAX_DATAGRAM, PBUF_RAM);
+            bridge_lwip_end();
+            if (!tx_pbuf) {
+                bridge_stats.tx_dropped += len;
+                return;
+            }
+            tx_fill = 0;
+            tx_first_us = hal_time_us();
+            hal_alarm_in_us(UDP_BRIDGE_FLUSH_US, udp_bridge_wake, NULL);
+        }
+
+        size_t n = UDP_BRIDGE_MAX_DATAGRAM - tx_fill;
+        if (n > len) {
+            n = len;
+        }
+        memcpy((uint8_t *)tx_pbuf->payload + tx_fill, data, n);
+        tx_fill += n;
+        data += n;
+        len -= n;
+
+        if (tx_fill == UDP_BRIDGE_MAX_DATAGRAM) {
+            udp_bridge_flush();
+        }
+    }
+}
+
+void udp_bridge_poll(void) {
+    if (tx_pbuf && hal_time_us() - tx_first_us >= UDP_BRIDGE_FLUSH_US) {
+        udp_bridge_flush();
+    }
+
+    while (rx_sent_tail != rx_sent_head) {
+        __atomic_signal_fence(__ATOMIC_ACQUIRE);
+        struct pbuf *p = rx_sent[rx_sent_tail & (UART_TX_REFS - 1)];
+        rx_sent_tail++;
+        bridge_lwip_begin();
+        pbuf_free(p);
+        bridge_lwip_end();
+
+        uint32_t save = hal_irq_save();
+        rx_held--;
+        hal_irq_restore(save);
+    }
+}
+
+void udp_bridge_get_stats(udp_bridge_stats_t *stats) {
+    uint32_t save = hal_irq_save();
+    *stats = bridge_stats;
+    hal_irq_restore(save);
+}
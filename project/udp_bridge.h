@@ -0,0 +1,44 @@
+#ifndef UDP_BRIDGE_H
+#define UDP_BRIDGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "lwip/ip_addr.h"
+
+// Bridges one UART's byte stream to UDP in both directions. Bytes from the UART
+// are coalesced straight into a pbuf that is handed to lwIP once it holds
+// UDP_BRIDGE_MAX_DATAGRAM bytes, or UDP_BRIDGE_FLUSH_US after its first byte.
+// Datagrams from the peer are sent to the UART in place from their pbufs, up
+// to UART_TX_REFS of them at a time, and freed once sent.
+
+#ifndef UDP_BRIDGE_MAX_DATAGRAM
+#define UDP_BRIDGE_MAX_DATAGRAM 512
+#endif
+#ifndef UDP_BRIDGE_FLUSH_US
+#define UDP_BRIDGE_FLUSH_US 2000
+#endif
+
+typedef struct {
+    uint32_t tx_datagrams; // UART -> UDP
+    uint32_t tx_bytes;
+    uint32_t tx_dropped;   // UART bytes lost to pbuf exhaustion or send errors
+    uint32_t tx_late;      // datagrams flushed over a flush period past their deadline
+    uint32_t rx_datagrams; // UDP -> UART
+    uint32_t rx_bytes;
+    uint32_t rx_dropped;   // empty, or more than UART_TX_REFS waiting for the UART
+} udp_bridge_stats_t;
+
+bool udp_bridge_init(uint32_t uart_port, const ip_addr_t *peer, uint16_t peer_port, uint16_t local_port);
+
+// Main loop: bytes received on a UART, anything but the bridged port is ignored.
+// Matches app_rx_tap_t.
+void udp_bridge_feed(uint32_t uart_port, const uint8_t *data, size_t len);
+
+// Main loop: send the pending datagram once its flush time has passed, and
+// free the peer's datagrams the UART has finished sending
+void udp_bridge_poll(void);
+
+void udp_bridge_get_stats(udp_bridge_stats_t *stats);
+
+#endif